@@ -4,6 +4,8 @@
 #include "fhiclcpp/ParameterSet.h"
 #include "fhiclcpp/ParameterSetRegistry.h"
 
+#include <algorithm>
+
 void
 fhicl::decompose_fhicl(std::string const& filename,
                        std::vector<std::string>& records,
@@ -27,20 +29,16 @@ fhicl::decompose_parameterset(fhicl::ParameterSet const& top,
   hashes.push_back(top.id().to_string());
 
   // Recurse through all parameters, dealing with ParameterSets and
-  // vectors thereof.
-  std::vector<std::string> keys = top.get_names();
-  for (auto const& key : keys) {
-    if (top.is_key_to_table(key))
-      decompose_parameterset(top.get<ParameterSet>(key), records, hashes);
-    else if (top.is_key_to_sequence(key)) {
-      try {
-        auto nestlings = top.get<std::vector<ParameterSet>>(key);
-        for (auto const& ps : nestlings)
-          decompose_parameterset(ps, records, hashes);
-      }
-      catch (fhicl::exception const&) {
-        // The vector didn't contain ParameterSets, keep going; no
-        // corrective action is needed.
+  // sequences thereof.  The tables of sequences that also hold other
+  // values are not decomposed.
+  auto const is_table = [](auto const& element) { return element.is_table(); };
+  for (auto const& [key, value] : top.members()) {
+    if (value.is_table()) {
+      decompose_parameterset(value.table(), records, hashes);
+    } else if (value.is_sequence() &&
+               std::all_of(value.begin(), value.end(), is_table)) {
+      for (auto const& element : value) {
+        decompose_parameterset(element.table(), records, hashes);
       }
     }
   }
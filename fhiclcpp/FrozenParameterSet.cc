@@ -0,0 +1,485 @@
+// ======================================================================
+//
+// FrozenParameterSet
+//
+// ======================================================================
+
+#include "fhiclcpp/FrozenParameterSet.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/ParameterSetRegistry.h"
+#include "fhiclcpp/exception.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+using namespace fhicl;
+using namespace fhicl::detail;
+
+using std::any;
+using std::any_cast;
+
+// ======================================================================
+// Construction
+
+// The tree is flattened in two passes: the first determines the sizes
+// of the node array and of the character buffer, so that the block
+// can be obtained with a single allocation; the second fills it in.
+// Children are laid out after their parents, and each table's
+// members in std::map (i.e. sorted) order.
+
+struct fhicl::detail::frozen_builder {
+  frozen_node* nodes{nullptr};
+  char* chars{nullptr};
+  std::size_t n_nodes{1}; // The root table
+  std::size_t n_chars{};
+
+  // First pass
+  void count(any const& value);
+  void count_table(ParameterSet const& pset);
+
+  // Second pass
+  void fill(std::size_t index, any const& value);
+  void fill_table(std::size_t index, ParameterSet const& pset);
+  void fill_atom(std::size_t index, any const& value);
+
+private:
+  std::size_t next_node_{1};
+  std::size_t next_char_{};
+
+  std::uint32_t add_chars(std::string_view str);
+  std::uint32_t reserve_children(std::size_t index, std::size_t n);
+};
+
+namespace {
+  std::string
+  unescaped(any const& value)
+  {
+    std::string result;
+    decode(value, result);
+    return result;
+  }
+
+  // The handle keeps the table from being evicted while it is read.
+  ParameterSetRegistry::handle
+  table_of(any const& value)
+  {
+    return ParameterSetRegistry::acquire(
+      any_cast<ParameterSetID const&>(value));
+  }
+
+  std::uint32_t
+  checked_size(std::size_t const n)
+  {
+    if (n > std::numeric_limits<std::uint32_t>::max()) {
+      throw fhicl::exception(error::other,
+                             "Configuration is too large to be frozen.");
+    }
+    return static_cast<std::uint32_t>(n);
+  }
+}
+
+void
+frozen_builder::count(any const& value)
+{
+  if (is_table(value)) {
+    count_table(*table_of(value));
+  } else if (is_sequence(value)) {
+    auto const& seq = any_cast<ps_sequence_t const&>(value);
+    n_nodes += seq.size();
+    for (auto const& element : seq) {
+      count(element);
+    }
+  } else {
+    auto const& stored = any_cast<ps_atom_t const&>(value);
+    n_chars += stored.size();
+    if (!is_nil(value) && needs_unescaping(stored)) {
+      n_chars += unescaped(value).size();
+    }
+  }
+}
+
+void
+frozen_builder::count_table(ParameterSet const& pset)
+{
+  auto const& mapping = FrozenParameterSet::mapping_of_(pset);
+  n_nodes += mapping.size();
+  for (auto const& [key, value] : mapping) {
+    n_chars += key.size();
+    count(value);
+  }
+}
+
+std::uint32_t
+frozen_builder::add_chars(std::string_view const str)
+{
+  auto const offset = next_char_;
+  str.copy(chars + offset, str.size());
+  next_char_ += str.size();
+  return checked_size(offset);
+}
+
+std::uint32_t
+frozen_builder::reserve_children(std::size_t const index, std::size_t const n)
+{
+  auto const first = next_node_;
+  next_node_ += n;
+  nodes[index].first = checked_size(first - index);
+  nodes[index].count = checked_size(n);
+  return checked_size(first);
+}
+
+void
+frozen_builder::fill(std::size_t const index, any const& value)
+{
+  if (is_table(value)) {
+    fill_table(index, *table_of(value));
+  } else if (is_sequence(value)) {
+    auto const& seq = any_cast<ps_sequence_t const&>(value);
+    nodes[index].kind = value_kind::sequence;
+    auto const first = reserve_children(index, seq.size());
+    for (std::size_t i = 0; i != seq.size(); ++i) {
+      fill(first + i, seq[i]);
+    }
+  } else {
+    fill_atom(index, value);
+  }
+}
+
+void
+frozen_builder::fill_table(std::size_t const index, ParameterSet const& pset)
+{
+  auto const& mapping = FrozenParameterSet::mapping_of_(pset);
+  nodes[index].kind = value_kind::table;
+  auto i = reserve_children(index, mapping.size());
+  for (auto const& [key, value] : mapping) {
+    nodes[i].key_offset = add_chars(key);
+    nodes[i].key_size = checked_size(key.size());
+    fill(i, value);
+    ++i;
+  }
+}
+
+void
+frozen_builder::fill_atom(std::size_t const index, any const& value)
+{
+  auto const& stored = any_cast<ps_atom_t const&>(value);
+  auto& node = nodes[index];
+  auto const offset = add_chars(stored);
+  node.first = offset;
+  node.count = checked_size(stored.size());
+  if (is_nil(value)) {
+    node.kind = value_kind::nil;
+    return;
+  }
+  node.kind = value_kind::atom;
+
+  // Pre-decode the string value, sharing the stored characters
+  // unless unescaping is required.
+  if (needs_unescaping(stored)) {
+    auto const text = unescaped(value);
+    node.text_offset = add_chars(text);
+    node.text_size = checked_size(text.size());
+  } else {
+    auto const view = atom_view(value);
+    node.text_offset = offset + checked_size(view.data() - stored.data());
+    node.text_size = checked_size(view.size());
+  }
+
+  std::string_view const text{chars + node.text_offset, node.text_size};
+  if (!try_decode_number(text, node.number)) {
+    node.flags |= frozen_node::has_number;
+  } else if (text == "true") {
+    node.flags |= frozen_node::is_true;
+  } else if (text == "false") {
+    node.flags |= frozen_node::is_false;
+  }
+}
+
+// ----------------------------------------------------------------------
+
+FrozenParameterSet::FrozenParameterSet()
+  : FrozenParameterSet{ParameterSet{}, std::pmr::get_default_resource()}
+{}
+
+FrozenParameterSet::FrozenParameterSet(ParameterSet const& pset,
+                                       std::pmr::memory_resource* resource)
+  : id_{pset.id()}
+{
+  frozen_builder builder;
+  builder.count_table(pset);
+
+  // Nodes first, so that they are suitably aligned; then characters.
+  auto const nodes_size = builder.n_nodes * sizeof(frozen_node);
+  size_ = nodes_size + builder.n_chars;
+  constexpr auto alignment = alignof(frozen_node);
+  auto* block = static_cast<std::byte*>(resource->allocate(size_, alignment));
+  auto release = [resource, size = size_](std::byte const* p) {
+    resource->deallocate(const_cast<std::byte*>(p), size, alignment);
+  };
+  block_ = std::shared_ptr<std::byte const>{
+    block, release, std::pmr::polymorphic_allocator<std::byte>{resource}};
+
+  builder.nodes = reinterpret_cast<frozen_node*>(block);
+  std::uninitialized_value_construct_n(builder.nodes, builder.n_nodes);
+  builder.chars = reinterpret_cast<char*>(block + nodes_size);
+  builder.fill_table(0, pset);
+  chars_ = builder.chars;
+}
+
+FrozenParameterSet
+fhicl::freeze(ParameterSet const& pset, std::pmr::memory_resource* resource)
+{
+  return FrozenParameterSet{pset, resource};
+}
+
+auto
+FrozenParameterSet::mapping_of_(ParameterSet const& pset) -> map_t const&
+{
+  return pset.mapping_;
+}
+
+ParameterSet
+FrozenParameterSet::make_(map_t&& mapping)
+{
+  ParameterSet result;
+  result.mapping_ = std::move(mapping);
+  return result;
+}
+
+// ----------------------------------------------------------------------
+
+std::string_view
+FrozenParameterSet::get_view(std::string_view const key) const
+{
+  auto const value = lookup(key);
+  if (!value) {
+    FrozenValue::throw_get_error_(get_error::missing, key, "std::string_view");
+  }
+  return value.as_view();
+}
+
+ParameterSet
+FrozenParameterSet::thaw() const
+{
+  ParameterSetRegistry::batch batch;
+  auto result = root().to_table_();
+  batch.publish();
+  return result;
+}
+
+// ======================================================================
+// FrozenValue
+
+frozen_node const*
+FrozenValue::children_() const noexcept
+{
+  return (is_sequence() || is_table()) ? node_ + node_->first : nullptr;
+}
+
+std::string_view
+FrozenValue::stored_text_() const noexcept
+{
+  return {chars_ + node_->first, node_->count};
+}
+
+FrozenValue
+FrozenValue::operator[](std::size_t const index) const noexcept
+{
+  return (is_sequence() && index < node_->count) ?
+           FrozenValue{children_() + index, chars_} :
+           FrozenValue{};
+}
+
+FrozenValue
+FrozenValue::member_(std::string_view const name) const noexcept
+{
+  if (!is_table()) {
+    return {};
+  }
+  auto const* first = children_();
+  auto const* last = first + node_->count;
+  auto const* it =
+    std::lower_bound(first, last, name, [this](auto const& node, auto name) {
+      return std::string_view{chars_ + node.key_offset, node.key_size} < name;
+    });
+  if (it == last ||
+      std::string_view{chars_ + it->key_offset, it->key_size} != name) {
+    return {};
+  }
+  return {it, chars_};
+}
+
+// Keys have the form 'a.b[2][0].c'; malformed keys are not found.
+FrozenValue
+FrozenValue::operator[](std::string_view key) const noexcept
+{
+  FrozenValue result{*this};
+  bool expect_name{true};
+  while (result && !key.empty()) {
+    if (key.front() == '[') {
+      auto const close = key.find(']');
+      if (close == std::string_view::npos || close == 1) {
+        return {};
+      }
+      std::size_t index{};
+      for (auto const c : key.substr(1, close - 1)) {
+        if (c < '0' || c > '9') {
+          return {};
+        }
+        index = index * 10 + (c - '0');
+      }
+      result = result[index];
+      key.remove_prefix(close + 1);
+    } else if (expect_name) {
+      auto const end = key.find_first_of(".[");
+      auto const name = key.substr(0, end);
+      if (name.empty()) {
+        return {};
+      }
+      result = result.member_(name);
+      key.remove_prefix(name.size());
+    } else {
+      return {};
+    }
+    expect_name = false;
+    if (!key.empty() && key.front() == '.') {
+      key.remove_prefix(1);
+      if (key.empty()) {
+        return {};
+      }
+      expect_name = true;
+    }
+  }
+  return result;
+}
+
+std::string_view
+FrozenValue::as_view() const
+{
+  if (!exists()) {
+    throw_get_error_(get_error::missing, key(), "std::string_view");
+  }
+  if (!is_atom()) {
+    throw_get_error_(get_error::type_mismatch, key(), "std::string_view");
+  }
+  return {chars_ + node_->text_offset, node_->text_size};
+}
+
+// ----------------------------------------------------------------------
+
+any
+FrozenValue::to_any_() const
+{
+  switch (kind()) {
+  case value_kind::sequence: {
+    ps_sequence_t result;
+    result.reserve(size());
+    for (auto const& element : *this) {
+      result.push_back(element.to_any_());
+    }
+    return result;
+  }
+  case value_kind::table:
+    return ParameterSetRegistry::put(to_table_());
+  default:
+    return std::string{stored_text_()};
+  }
+}
+
+ParameterSet
+FrozenValue::to_table_() const
+{
+  FrozenParameterSet::map_t mapping;
+  for (auto const& member : *this) {
+    mapping.emplace_hint(
+      mapping.end(), std::string{member.key()}, member.to_any_());
+  }
+  return FrozenParameterSet::make_(std::move(mapping));
+}
+
+void
+FrozenValue::throw_get_error_(get_error const error,
+                              std::string_view const key,
+                              std::string const& type)
+{
+  if (error == get_error::missing) {
+    throw fhicl::exception(cant_find, std::string{key});
+  }
+  throw fhicl::exception(type_mismatch)
+    << "\nUnsuccessful attempt to convert FHiCL parameter '" << key
+    << "' to type '" << type << "'.\n";
+}
+
+// ----------------------------------------------------------------------
+
+decode_status
+FrozenValue::decode_(std::string& result) const
+{
+  if (!is_atom()) {
+    return get_error::type_mismatch;
+  }
+  result.assign(chars_ + node_->text_offset, node_->text_size);
+  return std::nullopt;
+}
+
+decode_status
+FrozenValue::decode_(std::nullptr_t& result) const
+{
+  if (!is_nil()) {
+    return get_error::type_mismatch;
+  }
+  result = nullptr;
+  return std::nullopt;
+}
+
+decode_status
+FrozenValue::decode_(bool& result) const
+{
+  if (!is_atom() ||
+      !(node_->flags & (frozen_node::is_true | frozen_node::is_false))) {
+    return get_error::type_mismatch;
+  }
+  result = node_->flags & frozen_node::is_true;
+  return std::nullopt;
+}
+
+decode_status
+FrozenValue::decode_(ParameterSet& result) const
+{
+  if (!is_table()) {
+    return get_error::type_mismatch;
+  }
+  result = to_table_();
+  return std::nullopt;
+}
+
+decode_status
+FrozenValue::decode_(std::uintmax_t& result) const
+{
+  ldbl via{};
+  if (auto const status = decode_(via)) {
+    return status;
+  }
+  return try_narrow(via, result);
+}
+
+decode_status
+FrozenValue::decode_(std::intmax_t& result) const
+{
+  ldbl via{};
+  if (auto const status = decode_(via)) {
+    return status;
+  }
+  return try_narrow(via, result);
+}
+
+decode_status
+FrozenValue::decode_(ldbl& result) const
+{
+  if (!is_atom() || !(node_->flags & frozen_node::has_number)) {
+    return get_error::type_mismatch;
+  }
+  result = node_->number;
+  return std::nullopt;
+}
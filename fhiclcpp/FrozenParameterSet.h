@@ -0,0 +1,593 @@
+#ifndef fhiclcpp_FrozenParameterSet_h
+#define fhiclcpp_FrozenParameterSet_h
+
+// ======================================================================
+//
+// FrozenParameterSet: Immutable, flattened copy of a ParameterSet for
+//                     read-mostly access.
+//
+// 'freeze(pset)' copies the entire configuration tree rooted at 'pset'
+// into a single contiguous memory block.  Nested tables are inlined,
+// the members of each table are kept sorted by key (and found by
+// binary search), and each atom is decoded once, at freeze time, into
+// its string and (where applicable) numeric and boolean values.
+// Reading from a FrozenParameterSet therefore neither allocates
+// (except for the values returned) nor consults the
+// ParameterSetRegistry, and it requires no locking: a
+// FrozenParameterSet may be read concurrently from any number of
+// threads.
+//
+//   auto const frozen = fhicl::freeze(pset);
+//   auto const threshold = frozen.get<double>("filters.f1.threshold");
+//   for (auto const& module : frozen.lookup("physics.producers")) {
+//     std::cout << module.key() << '\n';
+//   }
+//   assert(frozen.thaw() == pset);
+//
+// Copies of a FrozenParameterSet share the same memory block.  A
+// FrozenValue is a non-owning handle to a node of that block; it must
+// not outlive the FrozenParameterSet from which it was obtained.
+//
+// The block (and the bookkeeping needed to share it) is obtained from
+// the std::pmr::memory_resource passed to 'freeze', so that a frozen
+// configuration may be placed in an arena and released in one shot:
+//
+//   std::pmr::monotonic_buffer_resource arena;
+//   auto const frozen = fhicl::freeze(pset, &arena);
+//
+// The resource must outlive the FrozenParameterSet and all of its
+// copies.  The block contains no pointers: nodes refer to each other
+// and to their characters by offset.
+//
+// ======================================================================
+
+#include "cetlib_except/demangle.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/ParameterSetID.h"
+#include "fhiclcpp/ValueView.h"
+#include "fhiclcpp/coding.h"
+#include "fhiclcpp/fwd.h"
+#include "fhiclcpp/get_result.h"
+#include "fhiclcpp/type_traits.h"
+
+#include <any>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fhicl {
+  class FrozenParameterSet;
+  class FrozenValue;
+
+  FrozenParameterSet freeze(
+    ParameterSet const& pset,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  namespace detail {
+    struct frozen_builder;
+
+    // One node of the flattened tree.  The children of a sequence or
+    // table occupy consecutive nodes; the members of a table are
+    // sorted by key.
+    struct frozen_node {
+      enum flag : std::uint32_t { has_number = 1, is_true = 2, is_false = 4 };
+
+      ldbl number; // pre-decoded value if (flags & has_number)
+      std::uint32_t key_offset;
+      std::uint32_t key_size;
+      std::uint32_t first; // atoms: stored text; others: first child,
+                           // relative to this node
+      std::uint32_t count; // atoms: size of stored text; others: #children
+      std::uint32_t text_offset; // atoms: decoded string
+      std::uint32_t text_size;
+      value_kind kind;
+      std::uint32_t flags;
+    };
+  }
+}
+
+// ----------------------------------------------------------------------
+
+class fhicl::FrozenValue {
+public:
+  class const_iterator;
+
+  // An absent value.
+  FrozenValue() = default;
+
+  // observers:
+  value_kind kind() const noexcept;
+  explicit operator bool() const noexcept;
+  bool exists() const noexcept;
+  bool is_nil() const noexcept;
+  bool is_atom() const noexcept;
+  bool is_sequence() const noexcept;
+  bool is_table() const noexcept;
+
+  // Key of a table member; empty otherwise.
+  std::string_view key() const noexcept;
+
+  // Number of sequence elements or table members; zero otherwise.
+  std::size_t size() const noexcept;
+  bool empty() const noexcept;
+
+  // children (absent if not present):
+  FrozenValue operator[](std::size_t index) const noexcept;
+  FrozenValue operator[](std::string_view key) const noexcept; // nested OK
+
+  const_iterator begin() const noexcept;
+  const_iterator end() const noexcept;
+
+  // retrievers:
+  template <class T>
+  T as() const;
+  template <class T>
+  get_result<T> try_as() const;
+  std::string_view as_view() const;
+
+private:
+  friend class FrozenParameterSet;
+
+  using decode_status = detail::decode_status;
+  using ldbl = detail::ldbl;
+
+  FrozenValue(detail::frozen_node const* node, char const* chars) noexcept
+    : node_{node}, chars_{chars}
+  {}
+
+  detail::frozen_node const* children_() const noexcept;
+  FrozenValue member_(std::string_view name) const noexcept;
+  std::string_view stored_text_() const noexcept;
+
+  // Conversions back to the ParameterSet representation.
+  std::any to_any_() const;
+  ParameterSet to_table_() const;
+
+  [[noreturn]] static void throw_get_error_(get_error error,
+                                            std::string_view key,
+                                            std::string const& type);
+
+  decode_status decode_(std::string&) const;
+  decode_status decode_(std::nullptr_t&) const;
+  decode_status decode_(bool&) const;
+  decode_status decode_(ParameterSet&) const;
+  decode_status decode_(std::uintmax_t&) const;
+  decode_status decode_(std::intmax_t&) const;
+  decode_status decode_(ldbl&) const;
+
+  template <class T>
+  std::enable_if_t<tt::is_uint<T>::value, decode_status> decode_(T&) const;
+  template <class T>
+  std::enable_if_t<tt::is_int<T>::value, decode_status> decode_(T&) const;
+  template <class T>
+  std::enable_if_t<std::is_floating_point_v<T>, decode_status> decode_(
+    T&) const;
+  template <class T>
+  decode_status decode_(std::vector<T>&) const;
+  template <class T, std::size_t SIZE>
+  decode_status decode_(std::array<T, SIZE>&) const;
+  template <class KEY, class VALUE>
+  decode_status decode_(std::pair<KEY, VALUE>&) const;
+  template <class... ARGS>
+  decode_status decode_(std::tuple<ARGS...>&) const;
+  template <class T>
+  tt::disable_if_t<tt::is_numeric<T>::value, decode_status> decode_(
+    T&) const; // none of the above
+
+  template <class U>
+  decode_status decode_tuple_(U&) const;
+  template <class U, std::size_t... I>
+  decode_status decode_tuple_entries_(U&, std::index_sequence<I...>) const;
+
+  detail::frozen_node const* node_{nullptr};
+  char const* chars_{nullptr};
+}; // FrozenValue
+
+// ----------------------------------------------------------------------
+
+class fhicl::FrozenValue::const_iterator {
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = FrozenValue;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = FrozenValue;
+
+  const_iterator() = default;
+
+  FrozenValue
+  operator*() const noexcept
+  {
+    return {node_, chars_};
+  }
+  const_iterator&
+  operator++() noexcept
+  {
+    ++node_;
+    return *this;
+  }
+  const_iterator
+  operator++(int) noexcept
+  {
+    auto tmp = *this;
+    ++node_;
+    return tmp;
+  }
+
+  bool
+  operator==(const_iterator const& other) const noexcept
+  {
+    return node_ == other.node_;
+  }
+  bool
+  operator!=(const_iterator const& other) const noexcept
+  {
+    return node_ != other.node_;
+  }
+
+private:
+  friend class FrozenValue;
+  const_iterator(detail::frozen_node const* node, char const* chars) noexcept
+    : node_{node}, chars_{chars}
+  {}
+
+  detail::frozen_node const* node_{nullptr};
+  char const* chars_{nullptr};
+};
+
+// ----------------------------------------------------------------------
+
+class fhicl::FrozenParameterSet {
+public:
+  // An empty table.
+  FrozenParameterSet();
+
+  ParameterSetID const& id() const noexcept;
+  // Size of the memory block holding the frozen tree.
+  std::size_t size_in_bytes() const noexcept;
+
+  FrozenValue root() const noexcept;
+  FrozenValue::const_iterator begin() const noexcept;
+  FrozenValue::const_iterator end() const noexcept;
+
+  // retrievers (nested key OK):
+  FrozenValue lookup(std::string_view key) const noexcept;
+  bool has_key(std::string_view key) const noexcept;
+
+  template <class T>
+  T get(std::string_view key) const;
+  template <class T>
+  get_result<T> try_get(std::string_view key) const;
+  std::string_view get_view(std::string_view key) const;
+
+  // The equivalent ParameterSet, with the same ID.
+  ParameterSet thaw() const;
+
+private:
+  friend FrozenParameterSet freeze(ParameterSet const&,
+                                   std::pmr::memory_resource*);
+  friend class FrozenValue;
+  friend struct detail::frozen_builder;
+
+  using map_t = std::map<std::string, std::any>;
+  static map_t const& mapping_of_(ParameterSet const& pset);
+  static ParameterSet make_(map_t&& mapping);
+
+  FrozenParameterSet(ParameterSet const& pset,
+                     std::pmr::memory_resource* resource);
+
+  std::shared_ptr<std::byte const> block_;
+  std::size_t size_{};
+  char const* chars_{nullptr};
+  ParameterSetID id_;
+}; // FrozenParameterSet
+
+// ======================================================================
+
+inline fhicl::value_kind
+fhicl::FrozenValue::kind() const noexcept
+{
+  return node_ == nullptr ? value_kind::absent : node_->kind;
+}
+
+inline fhicl::FrozenValue::operator bool() const noexcept
+{
+  return exists();
+}
+
+inline bool
+fhicl::FrozenValue::exists() const noexcept
+{
+  return node_ != nullptr;
+}
+
+inline bool
+fhicl::FrozenValue::is_nil() const noexcept
+{
+  return kind() == value_kind::nil;
+}
+
+inline bool
+fhicl::FrozenValue::is_atom() const noexcept
+{
+  return kind() == value_kind::atom;
+}
+
+inline bool
+fhicl::FrozenValue::is_sequence() const noexcept
+{
+  return kind() == value_kind::sequence;
+}
+
+inline bool
+fhicl::FrozenValue::is_table() const noexcept
+{
+  return kind() == value_kind::table;
+}
+
+inline std::string_view
+fhicl::FrozenValue::key() const noexcept
+{
+  return node_ == nullptr ? std::string_view{} :
+                            std::string_view{chars_ + node_->key_offset,
+                                             node_->key_size};
+}
+
+inline std::size_t
+fhicl::FrozenValue::size() const noexcept
+{
+  return (is_sequence() || is_table()) ? node_->count : 0ull;
+}
+
+inline bool
+fhicl::FrozenValue::empty() const noexcept
+{
+  return size() == 0ull;
+}
+
+inline auto
+fhicl::FrozenValue::begin() const noexcept -> const_iterator
+{
+  return {children_(), chars_};
+}
+
+inline auto
+fhicl::FrozenValue::end() const noexcept -> const_iterator
+{
+  auto const* first = children_();
+  return {first == nullptr ? nullptr : first + node_->count, chars_};
+}
+
+template <class T>
+T
+fhicl::FrozenValue::as() const
+{
+  auto result = try_as<T>();
+  if (!result) {
+    throw_get_error_(
+      result.error(), key(), cet::demangle_symbol(typeid(T).name()));
+  }
+  return std::move(result).value();
+}
+
+template <class T>
+fhicl::get_result<T>
+fhicl::FrozenValue::try_as() const
+{
+  if (!exists()) {
+    return get_error::missing;
+  }
+  T value{};
+  if (auto const status = decode_(value)) {
+    return *status;
+  }
+  return value;
+}
+
+// ----------------------------------------------------------------------
+
+template <class T>
+std::enable_if_t<tt::is_uint<T>::value, fhicl::detail::decode_status>
+fhicl::FrozenValue::decode_(T& result) const
+{
+  std::uintmax_t via{};
+  if (auto const status = decode_(via)) {
+    return status;
+  }
+  if (via > std::numeric_limits<T>::max()) {
+    return get_error::out_of_range;
+  }
+  result = static_cast<T>(via);
+  return std::nullopt;
+}
+
+template <class T>
+std::enable_if_t<tt::is_int<T>::value, fhicl::detail::decode_status>
+fhicl::FrozenValue::decode_(T& result) const
+{
+  std::intmax_t via{};
+  if (auto const status = decode_(via)) {
+    return status;
+  }
+  if (via < std::numeric_limits<T>::min() ||
+      via > std::numeric_limits<T>::max()) {
+    return get_error::out_of_range;
+  }
+  result = static_cast<T>(via);
+  return std::nullopt;
+}
+
+template <class T>
+std::enable_if_t<std::is_floating_point_v<T>, fhicl::detail::decode_status>
+fhicl::FrozenValue::decode_(T& result) const
+{
+  ldbl via{};
+  if (auto const status = decode_(via)) {
+    return status;
+  }
+  result = via;
+  return std::nullopt;
+}
+
+template <class T>
+fhicl::detail::decode_status
+fhicl::FrozenValue::decode_(std::vector<T>& result) const
+{
+  if (!is_sequence()) {
+    // Sequences stored as string atoms.
+    return is_atom() ? detail::try_decode(to_any_(), result) :
+                       get_error::type_mismatch;
+  }
+  result.clear();
+  result.reserve(size());
+  T via{};
+  for (auto const& element : *this) {
+    if (auto const status = element.decode_(via)) {
+      return status;
+    }
+    result.push_back(via);
+  }
+  return std::nullopt;
+}
+
+template <class T, std::size_t SIZE>
+fhicl::detail::decode_status
+fhicl::FrozenValue::decode_(std::array<T, SIZE>& result) const
+{
+  return decode_tuple_(result);
+}
+
+template <class KEY, class VALUE>
+fhicl::detail::decode_status
+fhicl::FrozenValue::decode_(std::pair<KEY, VALUE>& result) const
+{
+  return decode_tuple_(result);
+}
+
+template <class... ARGS>
+fhicl::detail::decode_status
+fhicl::FrozenValue::decode_(std::tuple<ARGS...>& result) const
+{
+  return decode_tuple_(result);
+}
+
+template <class U>
+fhicl::detail::decode_status
+fhicl::FrozenValue::decode_tuple_(U& result) const
+{
+  constexpr std::size_t TUPLE_SIZE = std::tuple_size_v<U>;
+  if (!is_sequence() || size() != TUPLE_SIZE) {
+    return get_error::type_mismatch;
+  }
+  return decode_tuple_entries_(result, std::make_index_sequence<TUPLE_SIZE>());
+}
+
+template <class U, std::size_t... I>
+fhicl::detail::decode_status
+fhicl::FrozenValue::decode_tuple_entries_(U& result,
+                                          std::index_sequence<I...>) const
+{
+  auto const* first = children_();
+  decode_status status;
+  ((status = FrozenValue{first + I, chars_}.decode_(std::get<I>(result)),
+    !status) &&
+   ...);
+  return status;
+}
+
+template <class T> // none of the above
+tt::disable_if_t<tt::is_numeric<T>::value, fhicl::detail::decode_status>
+fhicl::FrozenValue::decode_(T& result) const
+{
+  if constexpr (std::is_same_v<T, FrozenValue>) {
+    result = *this;
+    return std::nullopt;
+  } else {
+    // No pre-decoded representation; convert from the ParameterSet
+    // representation instead.
+    return detail::try_decode(to_any_(), result);
+  }
+}
+
+// ----------------------------------------------------------------------
+
+inline fhicl::ParameterSetID const&
+fhicl::FrozenParameterSet::id() const noexcept
+{
+  return id_;
+}
+
+inline std::size_t
+fhicl::FrozenParameterSet::size_in_bytes() const noexcept
+{
+  return size_;
+}
+
+inline fhicl::FrozenValue
+fhicl::FrozenParameterSet::root() const noexcept
+{
+  return {reinterpret_cast<detail::frozen_node const*>(block_.get()), chars_};
+}
+
+inline fhicl::FrozenValue::const_iterator
+fhicl::FrozenParameterSet::begin() const noexcept
+{
+  return root().begin();
+}
+
+inline fhicl::FrozenValue::const_iterator
+fhicl::FrozenParameterSet::end() const noexcept
+{
+  return root().end();
+}
+
+inline fhicl::FrozenValue
+fhicl::FrozenParameterSet::lookup(std::string_view const key) const noexcept
+{
+  return root()[key];
+}
+
+inline bool
+fhicl::FrozenParameterSet::has_key(std::string_view const key) const noexcept
+{
+  return lookup(key).exists();
+}
+
+template <class T>
+T
+fhicl::FrozenParameterSet::get(std::string_view const key) const
+{
+  auto result = try_get<T>(key);
+  if (!result) {
+    FrozenValue::throw_get_error_(
+      result.error(), key, cet::demangle_symbol(typeid(T).name()));
+  }
+  return std::move(result).value();
+}
+
+template <class T>
+fhicl::get_result<T>
+fhicl::FrozenParameterSet::try_get(std::string_view const key) const
+{
+  return lookup(key).try_as<T>();
+}
+
+// ======================================================================
+
+#endif /* fhiclcpp_FrozenParameterSet_h */
+
+// Local Variables:
+// mode: c++
+// End:
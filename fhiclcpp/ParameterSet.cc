@@ -15,9 +15,15 @@
 #include "fhiclcpp/extended_value.h"
 #include "fhiclcpp/intermediate_table.h"
 #include "fhiclcpp/parse.h"
+#include "tbb/parallel_for.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <functional>
+#include <iterator>
 #include <stack>
+#include <type_traits>
+#include <utility>
 
 using namespace fhicl;
 using namespace fhicl::detail;
@@ -32,6 +38,10 @@ using ps_sequence_t = ParameterSet::ps_sequence_t;
 using table_t = intermediate_table::table_t;
 using ldbl = long double;
 
+// Containers of ParameterSets must move, not copy, their elements when
+// they grow.
+static_assert(std::is_nothrow_move_constructible_v<ParameterSet>);
+
 // ======================================================================
 
 namespace {
@@ -54,24 +64,29 @@ namespace {
     }
   }
 
-  ParameterSet const&
+  ParameterSetRegistry::handle
   get_pset_via_any(std::any const& a)
   {
     ParameterSetID const& psid = std::any_cast<ParameterSetID>(a);
-    return ParameterSetRegistry::get(psid);
+    return ParameterSetRegistry::acquire(psid);
   }
 }
 
 // ----------------------------------------------------------------------
 
+// Nested tables are registered in a single batch once the whole
+// ParameterSet has been built.
+
 fhicl::ParameterSet
 fhicl::ParameterSet::make(intermediate_table const& tbl)
 {
+  ParameterSetRegistry::batch batch;
   ParameterSet result;
   for (auto const& [key, value] : tbl) {
     if (!value.in_prolog)
       result.put(key, value);
   }
+  batch.publish();
   return result;
 }
 
@@ -83,12 +98,14 @@ fhicl::ParameterSet::make(extended_value const& xval)
   if (!xval.is_a(TABLE))
     throw fhicl::exception(type_mismatch, "extended value not a table");
 
+  ParameterSetRegistry::batch batch;
   ParameterSet result;
   auto const& tbl = table_t(xval);
   for (auto const& [key, value] : tbl) {
     if (!value.in_prolog)
       result.put(key, value);
   }
+  batch.publish();
   return result;
 }
 
@@ -111,6 +128,126 @@ fhicl::ParameterSet::make(std::string const& filename,
   return ParameterSet::make(tbl);
 }
 
+// ======================================================================
+// Parallel make
+//
+// Sibling tables are independent of each other, so the members of a
+// table (and the elements of a sequence) that are themselves tables
+// or sequences are encoded concurrently.  Atoms are encoded inline,
+// since they are too cheap to be worth a task.  Each nested table is
+// hashed by the task that builds it, and the members are inserted in
+// their original order once all of them have been encoded, so that
+// the result does not depend on the scheduling.
+
+namespace {
+  bool
+  is_composite(extended_value const& xval)
+  {
+    return xval.is_a(TABLE) || xval.is_a(SEQUENCE);
+  }
+
+  // Calls 'encode(i)' for each index in [0, n); those for which
+  // 'is_composite(i)' is true are processed concurrently.
+  template <typename IsComposite, typename Encode>
+  void
+  encode_all(std::size_t const n,
+             IsComposite const& is_composite,
+             Encode const& encode)
+  {
+    std::vector<std::size_t> composites;
+    for (std::size_t i = 0; i != n; ++i) {
+      if (is_composite(i)) {
+        composites.push_back(i);
+      } else {
+        encode(i);
+      }
+    }
+    if (composites.size() < 2) {
+      for (auto const i : composites) {
+        encode(i);
+      }
+      return;
+    }
+    tbb::parallel_for(std::size_t{}, composites.size(), [&](std::size_t j) {
+      encode(composites[j]);
+    });
+  }
+}
+
+// Tables registered by one task may be looked up by another, so no
+// batching is done on the calling thread.
+
+fhicl::ParameterSet
+fhicl::ParameterSet::make_parallel(intermediate_table const& tbl)
+{
+  ParameterSetRegistry::batch const unbatched{false};
+  return make_parallel_(tbl);
+}
+
+fhicl::ParameterSet
+fhicl::ParameterSet::make_parallel(std::string const& filename,
+                                   cet::filepath_maker& maker)
+{
+  auto const tbl = parse_document(filename, maker);
+  return make_parallel(tbl);
+}
+
+template <typename Table>
+fhicl::ParameterSet
+fhicl::ParameterSet::make_parallel_(Table const& tbl)
+{
+  std::vector<std::pair<std::string const*, extended_value const*>> members;
+  for (auto const& [key, value] : tbl) {
+    if (!value.in_prolog) {
+      members.emplace_back(&key, &value);
+    }
+  }
+
+  std::vector<any> encoded(members.size());
+  auto const member_is_composite = [&members](std::size_t const i) {
+    return is_composite(*members[i].second);
+  };
+  encode_all(
+    members.size(), member_is_composite, [&members, &encoded](auto const i) {
+      auto const& [key, value] = members[i];
+      detail::try_insert(
+        [&encoded, i, value = value](auto const&) {
+          encoded[i] = encode_parallel_(*value);
+        },
+        *key);
+    });
+
+  ParameterSet result;
+  for (std::size_t i = 0, n = members.size(); i != n; ++i) {
+    auto const& [key, value] = members[i];
+    result.insert_(*key, encoded[i]);
+    fill_src_info(*value, *key, result.srcMapping_);
+  }
+  return result;
+}
+
+any
+ParameterSet::encode_parallel_(extended_value const& xval)
+{
+  if (xval.is_a(TABLE)) {
+    auto const& tbl = any_cast<table_t const&>(xval.value);
+    return ParameterSetRegistry::put(make_parallel_(tbl));
+  }
+  if (xval.is_a(SEQUENCE)) {
+    using sequence_t = extended_value::sequence_t;
+    auto const& seq = any_cast<sequence_t const&>(xval.value);
+    ps_sequence_t result(seq.size());
+    encode_all(
+      seq.size(),
+      [&seq](std::size_t const i) { return is_composite(seq[i]); },
+      [&seq, &result](std::size_t const i) {
+        result[i] = encode_parallel_(seq[i]);
+      });
+    return result;
+  }
+  return detail::encode(xval);
+}
+
 // ======================================================================
 
 string
@@ -119,7 +256,7 @@ ParameterSet::stringify_(any const& a, bool const compact) const
   string result;
   if (is_table(a)) {
     auto const& psid = any_cast<ParameterSetID>(a);
-    result = '{' + ParameterSetRegistry::get(psid).to_string() + '}';
+    result = '{' + ParameterSetRegistry::acquire(psid)->to_string() + '}';
     if (compact && result.size() > (5 + ParameterSetID::max_str_size())) {
       // Replace with a reference to the ParameterSetID;
       result = std::string("@id::") + psid.to_string();
@@ -135,12 +272,31 @@ ParameterSet::stringify_(any const& a, bool const compact) const
     }
     result.append(1, ']');
   } else { // is_atom(a)
-    ps_atom_t const str = any_cast<ps_atom_t>(a);
-    result = str == string(9, '\0') ? "@nil" : str;
+    result = is_nil(a) ? "@nil" : any_cast<ps_atom_t const&>(a);
   }
   return result;
 } // stringify_()
 
+// IDs of the tables directly referenced by this ParameterSet,
+// including those in (nested) sequences.  The registry is not
+// consulted, so the tables need not be present in it.
+void
+ParameterSet::collect_table_ids_(std::vector<ParameterSetID>& ids) const
+{
+  auto collect = [&ids](any const& a, auto const& self) -> void {
+    if (is_table(a)) {
+      ids.push_back(any_cast<ParameterSetID const&>(a));
+    } else if (is_sequence(a)) {
+      for (auto const& element : any_cast<ps_sequence_t const&>(a)) {
+        self(element, self);
+      }
+    }
+  };
+  for (auto const& [key, value] : mapping_) {
+    collect(value, collect);
+  }
+}
+
 // ----------------------------------------------------------------------
 
 bool
@@ -197,6 +353,51 @@ ParameterSet::get_pset_names() const
   return keys;
 }
 
+member_iterator
+ParameterSet::begin() const
+{
+  return members().begin();
+}
+
+member_iterator
+ParameterSet::end() const
+{
+  return members().end();
+}
+
+member_range
+ParameterSet::members() const
+{
+  return members_(member_filter::all);
+}
+
+member_range
+ParameterSet::table_members() const
+{
+  return members_(member_filter::tables);
+}
+
+member_range
+ParameterSet::sequence_members() const
+{
+  return members_(member_filter::sequences);
+}
+
+member_range
+ParameterSet::atom_members() const
+{
+  return members_(member_filter::atoms);
+}
+
+member_range
+ParameterSet::members_(member_filter const filter,
+                       registry_pin pin) const
+{
+  auto const e = mapping_.cend();
+  return {member_iterator{mapping_.cbegin(), e, this, filter, pin},
+          member_iterator{e, e, this, filter, std::move(pin)}};
+}
+
 vector<string>
 ParameterSet::get_all_keys() const
 {
@@ -205,50 +406,112 @@ ParameterSet::get_all_keys() const
   return ka.result();
 }
 
-bool
-ParameterSet::find_one_(std::string const& simple_key) const
+std::pair<ParameterSet const*, registry_pin>
+ParameterSet::descend_(std::vector<std::string> const& names,
+                       registry_pin pin) const
 {
-  auto skey = detail::get_sequence_indices(simple_key);
+  ParameterSet const* p{this};
+  for (auto const& name : names) {
+    auto const* a = p->find_any_(name);
+    if (a == nullptr || !is_table(*a)) {
+      return {nullptr, {}};
+    }
+    auto const table =
+      ParameterSetRegistry::acquire(any_cast<ParameterSetID const&>(*a));
+    p = &*table;
+    pin = table.pin();
+  }
+  return {p, std::move(pin)};
+}
+
+std::any const*
+ParameterSet::find_any_(std::string const& simple_key) const
+{
+  if (simple_key.find('[') == std::string::npos) {
+    auto it = mapping_.find(simple_key);
+    return it != mapping_.end() ? &it->second : nullptr;
+  }
 
+  auto skey = detail::get_sequence_indices(simple_key);
   auto it = mapping_.find(skey.name());
   if (it == mapping_.end()) {
-    return false;
+    return nullptr;
   }
 
-  auto a = it->second;
-  return detail::find_an_any(skey.indices().cbegin(), skey.indices().cend(), a);
+  std::any const* a = &it->second;
+  for (auto const index : skey.indices()) {
+    if (!is_sequence(*a)) {
+      return nullptr;
+    }
+    auto const& seq = any_cast<ps_sequence_t const&>(*a);
+    if (index >= seq.size()) {
+      return nullptr;
+    }
+    a = &seq[index];
+  }
+  return a;
+}
+
+ValueView
+ParameterSet::lookup(std::string const& key) const
+{
+  return lookup_(key, {});
 }
 
-std::optional<ParameterSet>
-ParameterSet::descend_(std::vector<std::string> const& names) const
+ValueView
+ParameterSet::lookup_(std::string const& key, registry_pin pin) const
 {
-  if (empty(names)) {
-    return std::make_optional(*this);
+  auto const keys = detail::get_names(key);
+  auto [table, table_pin] = descend_(keys.tables(), std::move(pin));
+  if (table == nullptr) {
+    return {};
   }
-  ParameterSet const* p{this};
-  std::optional<ParameterSet> result;
-  for (auto const& name : names) {
-    if (!p->find_one_(name)) {
-      return std::nullopt;
-    }
-    if (!p->is_key_to_table(name)) {
-      return std::nullopt;
-    }
+  auto const* a = table->find_any_(keys.last());
+  return a != nullptr ? ValueView{*a, *table, std::move(table_pin)} :
+                        ValueView{};
+}
 
-    if (result = p->get_one_<ParameterSet>(name); not result) {
-      return std::nullopt;
+namespace {
+  ValueView
+  existing_value(ParameterSet const& ps, std::string const& key)
+  {
+    auto value = ps.lookup(key);
+    if (!value) {
+      throw fhicl::exception(error::cant_find, key);
     }
-    p = &result.value();
+    return value;
   }
-  return result;
 }
 
 bool
 ParameterSet::has_key(std::string const& key) const
 {
-  auto keys = detail::get_names(key);
-  auto ps = descend_(keys.tables());
-  return ps ? ps->find_one_(keys.last()) : false;
+  return lookup(key).exists();
+}
+
+bool
+ParameterSet::is_key_to_table(std::string const& key) const
+{
+  return existing_value(*this, key).is_table();
+}
+
+bool
+ParameterSet::is_key_to_sequence(std::string const& key) const
+{
+  return existing_value(*this, key).is_sequence();
+}
+
+bool
+ParameterSet::is_key_to_atom(std::string const& key) const
+{
+  auto const value = existing_value(*this, key);
+  return value.is_atom() || value.is_nil();
+}
+
+std::string_view
+ParameterSet::get_view(std::string const& key) const
+{
+  return existing_value(*this, key).as_view();
 }
 
 // ----------------------------------------------------------------------
@@ -276,38 +539,143 @@ ParameterSet::put_or_replace(std::string const& key)
 
 // ----------------------------------------------------------------------
 
+// A nested key ("a.b[2].c") is handled by copying each table along
+// the path, applying the update to the innermost table (with key
+// "c"), and registering the modified copies from the innermost
+// outwards.  All other subtables remain shared by ID.  Missing tables
+// along the path are created, unless they are to be found in a
+// sequence.  Nothing is modified if the update fails.
+
 namespace {
-  inline void
-  check_put_local_key(std::string const& key)
+  inline bool
+  is_nested_key(std::string const& key)
   {
-    if (key.find('.') != std::string::npos) {
-      throw fhicl::exception(unimplemented, "putXXX() for nested key.");
+    return key.find('.') != std::string::npos;
+  }
+}
+
+// Returns the value for a local name, which may include sequence
+// indices ("b[2][0]").  A missing plain name yields nullptr; a missing
+// sequence or element is an error.
+any*
+ParameterSet::find_slot_(string const& name)
+{
+  if (name.find('[') == std::string::npos) {
+    auto found = mapping_.find(name);
+    return found == mapping_.end() ? nullptr : &found->second;
+  }
+  auto const skey = detail::get_sequence_indices(name);
+  auto found = mapping_.find(skey.name());
+  if (found == mapping_.end()) {
+    throw exception(cant_find) << "no sequence " << skey.name() << '.';
+  }
+  any* slot = &found->second;
+  for (auto const index : skey.indices()) {
+    if (!is_sequence(*slot) ||
+        index >= any_cast<ps_sequence_t const&>(*slot).size()) {
+      throw exception(cant_find) << "no element " << name << '.';
     }
+    slot = &any_cast<ps_sequence_t&>(*slot)[index];
+  }
+  return slot;
+}
+
+ParameterSet::ps_sequence_t&
+ParameterSet::find_sequence_(string const& name)
+{
+  any* const slot = find_slot_(name);
+  if (slot == nullptr) {
+    throw exception(cant_find) << "no sequence " << name << '.';
+  }
+  if (!is_sequence(*slot)) {
+    throw exception(type_mismatch) << name << " is not a sequence.";
+  }
+  return any_cast<ps_sequence_t&>(*slot);
+}
+
+template <typename F>
+void
+ParameterSet::update_path_(std::string const& key, F const& update_leaf)
+{
+  auto const keys = detail::get_names(key);
+  update_path_(
+    keys.tables().cbegin(), keys.tables().cend(), keys.last(), update_leaf);
+}
+
+template <typename F>
+void
+ParameterSet::update_path_(name_iter_t const it,
+                           name_iter_t const end,
+                           std::string const& leaf_key,
+                           F const& update_leaf)
+{
+  if (it == end) {
+    update_leaf(*this, leaf_key);
+    return;
+  }
+
+  auto const& name = *it;
+  any* const slot = find_slot_(name);
+  if (slot != nullptr && !is_table(*slot)) {
+    throw exception(cant_insert) << name << " is not a table.";
+  }
+
+  ParameterSet table;
+  if (slot != nullptr) {
+    table =
+      *ParameterSetRegistry::acquire(any_cast<ParameterSetID const&>(*slot));
   }
+  table.update_path_(std::next(it), end, leaf_key, update_leaf);
+  auto const id = ParameterSetRegistry::put(table);
+  if (slot != nullptr) {
+    *slot = id;
+  } else {
+    mapping_.emplace(name, id);
+  }
+  id_.invalidate();
 }
 
 void
 ParameterSet::insert_(string const& key, any const& value)
 {
-  check_put_local_key(key);
+  if (is_nested_key(key)) {
+    update_path_(key, [&value](ParameterSet& table, string const& local) {
+      table.insert_(local, value);
+    });
+    return;
+  }
   if (!mapping_.emplace(key, value).second) {
     throw exception(cant_insert) << "key " << key << " already exists.";
   }
   id_.invalidate();
+  unescaped_.clear();
 }
 
 void
 ParameterSet::insert_or_replace_(string const& key, any const& value)
 {
-  check_put_local_key(key);
+  if (is_nested_key(key)) {
+    update_path_(key, [&value](ParameterSet& table, string const& local) {
+      table.insert_or_replace_(local, value);
+      table.srcMapping_.erase(local);
+    });
+    return;
+  }
   mapping_[key] = value;
   id_.invalidate();
+  unescaped_.clear();
 }
 
 void
 ParameterSet::insert_or_replace_compatible_(string const& key, any const& value)
 {
-  check_put_local_key(key);
+  if (is_nested_key(key)) {
+    update_path_(key, [&value](ParameterSet& table, string const& local) {
+      table.insert_or_replace_compatible_(local, value);
+      table.srcMapping_.erase(local);
+    });
+    return;
+  }
   auto item = mapping_.find(key);
   if (item == mapping_.end()) {
     insert_(key, value);
@@ -332,6 +700,73 @@ ParameterSet::insert_or_replace_compatible_(string const& key, any const& value)
     item->second = value;
   }
   id_.invalidate();
+  unescaped_.clear();
+}
+
+// ----------------------------------------------------------------------
+// In-place sequence modification
+//
+// Only the affected sequence is touched; the other elements are
+// neither decoded nor re-encoded.
+
+void
+ParameterSet::append_(string const& key, any value)
+{
+  if (is_nested_key(key)) {
+    update_path_(key, [&value](ParameterSet& table, string const& local) {
+      table.append_(local, std::move(value));
+    });
+    return;
+  }
+  find_sequence_(key).push_back(std::move(value));
+  id_.invalidate();
+  unescaped_.clear();
+}
+
+void
+ParameterSet::set_element_(string const& key, any value)
+{
+  if (is_nested_key(key)) {
+    update_path_(key, [&value](ParameterSet& table, string const& local) {
+      table.set_element_(local, std::move(value));
+    });
+    return;
+  }
+  if (key.empty() || key.back() != ']') {
+    throw exception(cant_insert) << key << " is not a sequence element.";
+  }
+  any* const slot = find_slot_(key);
+  bool const was_sequence = is_sequence(*slot);
+  *slot = std::move(value);
+  id_.invalidate();
+  unescaped_.clear();
+
+  srcMapping_.erase(key);
+  if (was_sequence) {
+    auto const prefix = key + '[';
+    for (auto it = srcMapping_.begin(); it != srcMapping_.end();) {
+      it = it->first.compare(0, prefix.size(), prefix) == 0 ?
+             srcMapping_.erase(it) :
+             std::next(it);
+    }
+  }
+}
+
+void
+ParameterSet::reserve(string const& key, std::size_t const n)
+{
+  if (is_nested_key(key)) {
+    // Nested tables are copied whenever they are modified, and copies
+    // do not keep the capacity, so there is nothing to reserve.
+    if (!is_key_to_sequence(key)) {
+      throw exception(type_mismatch) << key << " is not a sequence.";
+    }
+    return;
+  }
+  // Reallocating the sequence moves its elements, invalidating the
+  // cached unescaped strings, which are keyed by address.
+  find_sequence_(key).reserve(n);
+  unescaped_.clear();
 }
 
 bool
@@ -339,31 +774,182 @@ ParameterSet::erase(string const& key)
 {
   bool const did_erase{1u == mapping_.erase(key)};
   id_.invalidate();
+  unescaped_.clear();
   return did_erase;
 }
 
+// ----------------------------------------------------------------------
+// Equality
+//
+// Two ParameterSets are equal if their IDs are equal.  If either ID
+// is not yet cached, computing it would require serializing and
+// hashing the entire ParameterSet.  We therefore compare the
+// ParameterSets structurally instead, which allows an early exit at
+// the first difference.  Nested tables are represented by their
+// ParameterSetIDs, so they are compared without descending into
+// them.
+//
+// The structural comparison is equivalent to ID comparison as long
+// as each value has an unambiguous string representation, which is
+// true for all values encoded by fhiclcpp.  Should two values of
+// different kinds (e.g. a sequence and an atom) be encountered at the
+// same key, we fall back to comparing IDs.
+
+namespace {
+  enum class comparison { equal, unequal, undecided };
+
+  comparison
+  compare_values(any const& a, any const& b)
+  {
+    if (is_table(a) && is_table(b)) {
+      return any_cast<ParameterSetID const&>(a) ==
+                 any_cast<ParameterSetID const&>(b) ?
+               comparison::equal :
+               comparison::unequal;
+    }
+    if (is_sequence(a) && is_sequence(b)) {
+      auto const& seq_a = any_cast<ps_sequence_t const&>(a);
+      auto const& seq_b = any_cast<ps_sequence_t const&>(b);
+      if (seq_a.size() != seq_b.size()) {
+        return comparison::unequal;
+      }
+      for (std::size_t i{}, sz = seq_a.size(); i != sz; ++i) {
+        if (auto const result = compare_values(seq_a[i], seq_b[i]);
+            result != comparison::equal) {
+          return result;
+        }
+      }
+      return comparison::equal;
+    }
+    if (is_table(a) || is_table(b) || is_sequence(a) || is_sequence(b)) {
+      return comparison::undecided;
+    }
+    return any_cast<ps_atom_t const&>(a) == any_cast<ps_atom_t const&>(b) ?
+             comparison::equal :
+             comparison::unequal;
+  }
+}
+
 bool
-ParameterSet::key_is_type_(std::string const& key,
-                           std::function<bool(std::any const&)> func) const
+ParameterSet::operator==(ParameterSet const& other) const
 {
-  auto split_keys = detail::get_names(key);
-  auto ps = descend_(split_keys.tables());
-  if (not ps) {
-    throw exception(error::cant_find, key);
+  if (this == &other) {
+    return true;
+  }
+  if (id_.is_valid() && other.id_.is_valid()) {
+    return id_ == other.id_;
   }
 
-  auto skey = detail::get_sequence_indices(split_keys.last());
+  // Key sets first...
+  if (mapping_.size() != other.mapping_.size()) {
+    return false;
+  }
+  auto const same_key = [](auto const& a, auto const& b) {
+    return a.first == b.first;
+  };
+  if (!std::equal(mapping_.cbegin(),
+                  mapping_.cend(),
+                  other.mapping_.cbegin(),
+                  same_key)) {
+    return false;
+  }
 
-  auto it = ps->mapping_.find(skey.name());
-  if (it == ps->mapping_.end()) {
-    throw exception(error::cant_find, key);
+  // ...then values.
+  for (auto it = mapping_.cbegin(), oit = other.mapping_.cbegin(),
+            e = mapping_.cend();
+       it != e;
+       ++it, ++oit) {
+    switch (compare_values(it->second, oit->second)) {
+    case comparison::equal:
+      continue;
+    case comparison::unequal:
+      return false;
+    case comparison::undecided:
+      return id() == other.id();
+    }
   }
+  return true;
+}
+
+// ======================================================================
+// Overlay
+//
+// Tables present in both the base and the overrides are merged
+// recursively; any other value from the overrides replaces the base
+// value.  Nested tables are referred to by ParameterSetID, so those
+// that are not modified are shared with the base (or the overrides)
+// rather than copied, and only the tables along a modified path are
+// re-registered (and hence re-hashed).
+
+namespace {
+  // Calls 'f' for the source-information key of 'value' and, for
+  // sequences, for those of its elements (see 'fill_src_info').
+  template <typename F>
+  void
+  for_each_src_key(std::string const& key, any const& value, F const& f)
+  {
+    f(key);
+    if (!is_sequence(value)) {
+      return;
+    }
+    auto const& seq = any_cast<ps_sequence_t const&>(value);
+    for (std::size_t i{}, sz = seq.size(); i != sz; ++i) {
+      for_each_src_key(key + '[' + std::to_string(i) + ']', seq[i], f);
+    }
+  }
+}
+
+ParameterSet
+ParameterSet::overlay(ParameterSet const& base, ParameterSet const& overrides)
+{
+  ParameterSet result{base};
+  result.overlay_(overrides);
+  return result;
+}
+
+bool
+ParameterSet::overlay_(ParameterSet const& overrides)
+{
+  bool changed{false};
+  for (auto const& [key, value] : overrides.mapping_) {
+    auto it = mapping_.find(key);
+    if (it != mapping_.end() && is_table(it->second) && is_table(value)) {
+      auto const& base_id = any_cast<ParameterSetID const&>(it->second);
+      auto const& overrides_id = any_cast<ParameterSetID const&>(value);
+      if (base_id == overrides_id) {
+        continue;
+      }
+      auto merged = *ParameterSetRegistry::acquire(base_id);
+      if (merged.overlay_(*ParameterSetRegistry::acquire(overrides_id))) {
+        it->second = ParameterSetRegistry::put(merged);
+        changed = true;
+      }
+      continue;
+    }
 
-  auto a = it->second;
-  return detail::find_an_any(
-           skey.indices().cbegin(), skey.indices().cend(), a) ?
-           func(a) :
-           throw exception(error::cant_find, key);
+    if (it == mapping_.end()) {
+      it = mapping_.emplace(key, value).first;
+      changed = true;
+    } else {
+      for_each_src_key(
+        key, it->second, [this](auto const& k) { srcMapping_.erase(k); });
+      if (compare_values(it->second, value) != comparison::equal) {
+        it->second = value;
+        changed = true;
+      }
+    }
+    for_each_src_key(key, value, [this, &overrides](auto const& k) {
+      if (auto src = overrides.srcMapping_.find(k);
+          src != overrides.srcMapping_.cend()) {
+        srcMapping_[k] = src->second;
+      }
+    });
+  }
+  if (changed) {
+    id_.invalidate();
+    unescaped_.clear();
+  }
+  return changed;
 }
 
 // ======================================================================
@@ -432,7 +1018,8 @@ ParameterSet::walk(ParameterSetWalker& psw) const
       psw.do_before_action(key, a, ps);
 
       if (is_table(a)) {
-        ParameterSet const* ps = &get_pset_via_any(a);
+        auto const table = get_pset_via_any(a);
+        ParameterSet const* ps = &*table;
         ps_stack.push(ps);
         psw.do_enter_table(key, a);
         for (auto const& [nested_key, nested_a] : ps->mapping_) {
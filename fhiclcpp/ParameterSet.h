@@ -9,6 +9,7 @@
 
 #include "cetlib_except/demangle.h"
 #include "fhiclcpp/ParameterSetID.h"
+#include "fhiclcpp/ValueView.h"
 #include "fhiclcpp/coding.h"
 #include "fhiclcpp/detail/ParameterSetImplHelpers.h"
 #include "fhiclcpp/detail/encode_extended_value.h"
@@ -16,15 +17,17 @@
 #include "fhiclcpp/detail/try_blocks.h"
 #include "fhiclcpp/exception.h"
 #include "fhiclcpp/fwd.h"
+#include "fhiclcpp/get_result.h"
 
 #include <any>
-#include <functional>
 #include <map>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <typeinfo>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 // ----------------------------------------------------------------------
@@ -33,6 +36,10 @@ namespace cetlib {
   class filepath_maker;
 }
 
+namespace fhicl::detail {
+  class binary_blob;
+}
+
 class fhicl::ParameterSet {
 public:
   using ps_atom_t = fhicl::detail::ps_atom_t;
@@ -46,6 +53,17 @@ public:
   static ParameterSet make(std::string const& str);
   static ParameterSet make(std::string const& filename,
                            cet::filepath_maker& maker);
+  // As 'make', but the nested tables are converted and registered
+  // concurrently (using TBB).  The result is identical to that of
+  // 'make'.
+  static ParameterSet make_parallel(intermediate_table const& tbl);
+  static ParameterSet make_parallel(std::string const& filename,
+                                    cet::filepath_maker& maker);
+
+  // Deep merge: tables are merged recursively; atoms and sequences
+  // from 'overrides' replace those of 'base'.
+  static ParameterSet overlay(ParameterSet const& base,
+                              ParameterSet const& overrides);
 
   // observers:
   bool is_empty() const;
@@ -65,7 +83,16 @@ public:
   std::vector<std::string> get_pset_names() const;
   std::vector<std::string> get_all_keys() const;
 
+  // (key, value) pairs of local members, in canonical key order:
+  member_iterator begin() const;
+  member_iterator end() const;
+  member_range members() const;
+  member_range table_members() const;
+  member_range sequence_members() const;
+  member_range atom_members() const; // Includes nil values.
+
   // retrievers (nested key OK):
+  ValueView lookup(std::string const& key) const;
   bool has_key(std::string const& key) const;
   bool is_key_to_table(std::string const& key) const;
   bool is_key_to_sequence(std::string const& key) const;
@@ -96,12 +123,20 @@ public:
         T const& default_value,
         T convert(Via const&)) const;
 
+  // Exception-free retrieval; failures are reported via the result.
+  template <class T>
+  get_result<T> try_get(std::string const& key) const;
+
+  // String value without copying; valid as long as this
+  // ParameterSet is neither modified nor destroyed.
+  std::string_view get_view(std::string const& key) const;
+
   std::string get_src_info(std::string const& key) const;
 
   // Facility to traverse the ParameterSet tree
   void walk(ParameterSetWalker& psw) const;
 
-  // inserters (key must be local: no nesting):
+  // inserters (nested key OK):
   void put(std::string const& key); // Implicit nil value.
   template <class T>                // Fail on preexisting key.
   void put(std::string const& key, T const& value);
@@ -111,6 +146,13 @@ public:
   template <class T> // Fail if preexisting key of incompatible type.
   void put_or_replace_compatible(std::string const& key, T const& value);
 
+  // in-place sequence modifiers (nested key OK; sequence must exist):
+  template <class T>
+  void append(std::string const& key, T const& value);
+  template <class T> // Key must name an existing element, e.g. "seq[2]".
+  void set_element(std::string const& key, T const& value);
+  void reserve(std::string const& key, std::size_t n);
+
   // deleters:
   bool erase(std::string const& key);
 
@@ -125,25 +167,56 @@ private:
   map_t mapping_;
   annot_t srcMapping_;
   mutable ParameterSetID id_;
+  mutable detail::UnescapedStringCache unescaped_;
 
-  // Private inserters.
+  // Private inserters.  Nested keys are supported (see 'update_path_').
   void insert_(std::string const& key, std::any const& value);
   void insert_or_replace_(std::string const& key, std::any const& value);
   void insert_or_replace_compatible_(std::string const& key,
                                      std::any const& value);
+  void append_(std::string const& key, std::any value);
+  void set_element_(std::string const& key, std::any value);
+  std::any* find_slot_(std::string const& name);
+  ps_sequence_t& find_sequence_(std::string const& name);
+  using name_iter_t = std::vector<std::string>::const_iterator;
+  template <typename F>
+  void update_path_(std::string const& key, F const& update_leaf);
+  template <typename F>
+  void update_path_(name_iter_t it,
+                    name_iter_t end,
+                    std::string const& leaf_key,
+                    F const& update_leaf);
 
   std::string to_string_(bool compact = false) const;
   std::string stringify_(std::any const& a, bool compact = false) const;
-
-  bool key_is_type_(std::string const& key,
-                    std::function<bool(std::any const&)> func) const;
+  // The pin, if any, keeps this (nested) table from being evicted
+  // from the registry while the range or the views obtained from it
+  // exist.
+  member_range members_(detail::member_filter filter,
+                        detail::registry_pin pin = {}) const;
+  ValueView lookup_(std::string const& key, detail::registry_pin pin) const;
+  bool overlay_(ParameterSet const& overrides);
+  void collect_table_ids_(std::vector<ParameterSetID>& ids) const;
+
+  template <typename Table>
+  static ParameterSet make_parallel_(Table const& tbl);
+  static std::any encode_parallel_(extended_value const& xval);
+
+  friend class FrozenParameterSet;
+  friend class ParameterSetRegistry;
+  friend class detail::binary_blob;
+  friend class ValueView;
 
   // Local retrieval only.
+  std::any const* find_any_(std::string const& key) const;
   template <class T>
   std::optional<T> get_one_(std::string const& key) const;
-  bool find_one_(std::string const& key) const;
-  std::optional<ParameterSet> descend_(
-    std::vector<std::string> const& names) const;
+  // The innermost of the nested tables named (or null if one is
+  // missing), which the returned pin keeps from being evicted; 'pin'
+  // is that of this table.
+  std::pair<ParameterSet const*, detail::registry_pin> descend_(
+    std::vector<std::string> const& names,
+    detail::registry_pin pin = {}) const;
 
 }; // ParameterSet
 
@@ -204,26 +277,6 @@ fhicl::ParameterSet::to_compact_string() const
   return to_string_(true);
 }
 
-inline bool
-fhicl::ParameterSet::is_key_to_table(std::string const& key) const
-{
-  return key_is_type_(key, &detail::is_table);
-}
-
-inline bool
-fhicl::ParameterSet::is_key_to_sequence(std::string const& key) const
-{
-  return key_is_type_(key, &detail::is_sequence);
-}
-
-inline bool
-fhicl::ParameterSet::is_key_to_atom(std::string const& key) const
-{
-  return key_is_type_(key, [](std::any const& a) {
-    return !(detail::is_sequence(a) || detail::is_table(a));
-  });
-}
-
 template <class T>
 void
 fhicl::ParameterSet::put(std::string const& key, T const& value)
@@ -260,17 +313,40 @@ fhicl::ParameterSet::put_or_replace_compatible(std::string const& key,
   detail::try_insert(insert_or_replace_compatible, key);
 }
 
+template <class T>
+void
+fhicl::ParameterSet::append(std::string const& key, T const& value)
+{
+  auto append = [this, &value](auto const& key) {
+    using detail::encode;
+    this->append_(key, std::any(encode(value)));
+  };
+  detail::try_insert(append, key);
+}
+
+template <class T>
+void
+fhicl::ParameterSet::set_element(std::string const& key, T const& value)
+{
+  auto set_element = [this, &value](auto const& key) {
+    using detail::encode;
+    this->set_element_(key, std::any(encode(value)));
+  };
+  detail::try_insert(set_element, key);
+}
+
 // ----------------------------------------------------------------------
 
 template <class T>
 std::optional<T>
 fhicl::ParameterSet::get_if_present(std::string const& key) const
 {
-  auto keys = detail::get_names(key);
-  if (auto ps = descend_(keys.tables())) {
-    return ps->get_one_<T>(keys.last());
+  auto const keys = detail::get_names(key);
+  auto const [table, pin] = descend_(keys.tables());
+  if (table == nullptr) {
+    return std::nullopt;
   }
-  return std::nullopt;
+  return table->get_one_<T>(keys.last());
 }
 
 template <class T, class Via>
@@ -346,15 +422,18 @@ fhicl::ParameterSet::get(std::string const& key,
 // ----------------------------------------------------------------------
 
 inline bool
-fhicl::ParameterSet::operator==(ParameterSet const& other) const
+fhicl::ParameterSet::operator!=(ParameterSet const& other) const
 {
-  return id() == other.id();
+  return !operator==(other);
 }
 
-inline bool
-fhicl::ParameterSet::operator!=(ParameterSet const& other) const
+// ----------------------------------------------------------------------
+
+template <class T>
+fhicl::get_result<T>
+fhicl::ParameterSet::try_get(std::string const& key) const
 {
-  return !operator==(other);
+  return lookup(key).try_as<T>();
 }
 
 // ----------------------------------------------------------------------
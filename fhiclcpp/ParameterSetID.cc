@@ -6,6 +6,7 @@
 
 #include "fhiclcpp/ParameterSetID.h"
 #include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/detail/sha1.h"
 
 #include <iomanip>
 
@@ -48,6 +49,10 @@ ParameterSetID::ParameterSetID(std::string const& id)
   }
 }
 
+ParameterSetID::ParameterSetID(sha1::digest_t const& digest) noexcept
+  : valid_{true}, id_{digest}
+{}
+
 // ----------------------------------------------------------------------
 
 bool
@@ -69,6 +74,12 @@ ParameterSetID::to_string() const
   return oss.str();
 }
 
+sha1::digest_t const&
+ParameterSetID::digest() const noexcept
+{
+  return id_;
+}
+
 // ----------------------------------------------------------------------
 
 void
@@ -82,9 +93,9 @@ void
 ParameterSetID::reset(ParameterSet const& ps)
 {
   auto const& hash = ps.to_string();
-  sha1 sha{hash.c_str()};
-
-  id_ = sha.digest();
+  // As with cet::sha1, the digest covers the string up to its first
+  // null character.
+  id_ = detail::sha1(hash.c_str());
   valid_ = true;
 }
 
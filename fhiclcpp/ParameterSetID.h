@@ -26,10 +26,12 @@ public:
   ParameterSetID() noexcept;
   explicit ParameterSetID(ParameterSet const&);
   explicit ParameterSetID(std::string const& id);
+  explicit ParameterSetID(cet::sha1::digest_t const& digest) noexcept;
 
   // observers:
   bool is_valid() const noexcept;
   std::string to_string() const;
+  cet::sha1::digest_t const& digest() const noexcept;
   static constexpr std::size_t max_str_size() noexcept;
 
   // mutators:
@@ -1,25 +1,209 @@
 #include "fhiclcpp/ParameterSetRegistry.h"
 
-#include "cetlib/container_algorithms.h"
 #include "cetlib/sqlite/Transaction.h"
 #include "cetlib/sqlite/column.h"
 #include "cetlib/sqlite/create_table.h"
 #include "cetlib/sqlite/exec.h"
-#include "cetlib/sqlite/query_result.h"
-#include "cetlib/sqlite/select.h"
 #include "fhiclcpp/ParameterSetID.h"
+#include "fhiclcpp/detail/binary_blob.h"
+#include "fhiclcpp/detail/mapped_registry_file.h"
 #include "fhiclcpp/exception.h"
 
 #include "sqlite3.h"
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
 
 using fhicl::detail::throwOnSQLiteFailure;
 
 std::recursive_mutex fhicl::ParameterSetRegistry::mutex_{};
+thread_local fhicl::ParameterSetRegistry::usage_map
+  fhicl::ParameterSetRegistry::pending_usages_{};
 
 namespace {
+#ifdef FHICLCPP_REGISTRY_STATS
+  constexpr bool stats_enabled{true};
+#else
+  constexpr bool stats_enabled{false};
+#endif
+
+  using statistics = fhicl::ParameterSetRegistry::statistics;
+  using steady_clock = std::chrono::steady_clock;
+
+  // With statistics disabled, counters hold nothing, and their
+  // operations, and those of stopwatches, are empty.
+  template <bool Enabled = stats_enabled>
+  class counter {
+  public:
+    void
+    add(std::uint64_t const n = 1) noexcept
+    {
+      value_.fetch_add(n, std::memory_order_relaxed);
+    }
+    std::uint64_t
+    load() const noexcept
+    {
+      return value_.load(std::memory_order_relaxed);
+    }
+    void
+    reset() noexcept
+    {
+      value_ = 0;
+    }
+
+  private:
+    std::atomic<std::uint64_t> value_{};
+  };
+
+  template <>
+  class counter<false> {
+  public:
+    void add(std::uint64_t = 1) noexcept {}
+    std::uint64_t
+    load() const noexcept
+    {
+      return 0;
+    }
+    void reset() noexcept {}
+  };
+
+  class stopwatch {
+  public:
+    stopwatch() noexcept
+    {
+      if constexpr (stats_enabled) {
+        start_ = steady_clock::now();
+      }
+    }
+    std::uint64_t
+    nanoseconds() const noexcept
+    {
+      if constexpr (stats_enabled) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 steady_clock::now() - start_)
+          .count();
+      }
+      return 0;
+    }
+
+  private:
+    steady_clock::time_point start_{};
+  };
+
+  class latency_counter {
+  public:
+    void
+    add(std::uint64_t const ns) noexcept
+    {
+      count_.add();
+      total_.add(ns);
+      std::size_t bucket{};
+      for (auto n = ns; n > 1 && bucket + 1 != histogram_.size(); n >>= 1) {
+        ++bucket;
+      }
+      histogram_[bucket].add();
+    }
+    statistics::latency
+    load() const noexcept
+    {
+      statistics::latency result{count_.load(), total_.load(), {}};
+      for (std::size_t i = 0; i != histogram_.size(); ++i) {
+        result.histogram[i] = histogram_[i].load();
+      }
+      return result;
+    }
+    void
+    reset() noexcept
+    {
+      count_.reset();
+      total_.reset();
+      for (auto& bucket : histogram_) {
+        bucket.reset();
+      }
+    }
+
+  private:
+    counter<> count_;
+    counter<> total_;
+    std::array<counter<>,
+               std::tuple_size_v<decltype(statistics::latency::histogram)>>
+      histogram_;
+  };
+
+  class operation_counter {
+  public:
+    void
+    add(std::uint64_t const rows, std::uint64_t const ns) noexcept
+    {
+      calls_.add();
+      rows_.add(rows);
+      total_.add(ns);
+    }
+    statistics::operation
+    load() const noexcept
+    {
+      return {calls_.load(), rows_.load(), total_.load()};
+    }
+    void
+    reset() noexcept
+    {
+      calls_.reset();
+      rows_.reset();
+      total_.reset();
+    }
+
+  private:
+    counter<> calls_;
+    counter<> rows_;
+    counter<> total_;
+  };
+
+  struct registry_counters {
+    counter<> new_puts;
+    counter<> duplicate_puts;
+    counter<> lookups;
+    latency_counter db_lookups;
+    latency_counter lock_waits;
+    operation_counter stage_in;
+    operation_counter import_from;
+    operation_counter export_to;
+  };
+
+  registry_counters s_counters;
+
+  // The number of locks on the backing DB held by the calling thread.
+  thread_local unsigned t_db_depth{};
+
+  class db_lock {
+  public:
+    explicit db_lock(std::recursive_mutex& m) : sentry_{m, std::defer_lock}
+    {
+      stopwatch const watch;
+      sentry_.lock();
+      s_counters.lock_waits.add(watch.nanoseconds());
+      ++t_db_depth;
+    }
+    ~db_lock() { --t_db_depth; }
+
+    db_lock(db_lock const&) = delete;
+    db_lock& operator=(db_lock const&) = delete;
+
+  private:
+    std::unique_lock<std::recursive_mutex> sentry_;
+  };
+
   sqlite3*
   openPrimaryDB()
   {
@@ -35,6 +219,153 @@ namespace {
     txn.commit();
     return result;
   }
+
+  constexpr char const* insert_sql{
+    "INSERT OR IGNORE INTO ParameterSets(ID, PSetBlob) VALUES(?, ?);"};
+
+  using statement_ptr = std::unique_ptr<sqlite3_stmt, int (*)(sqlite3_stmt*)>;
+
+  statement_ptr
+  prepare(sqlite3* db, char const* sql)
+  {
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+    statement_ptr result{stmt, sqlite3_finalize};
+    throwOnSQLiteFailure(db);
+    return result;
+  }
+
+  void
+  step_to_done(sqlite3* db, sqlite3_stmt* stmt)
+  {
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+      throwOnSQLiteFailure(db);
+    }
+    sqlite3_reset(stmt);
+  }
+
+  std::int64_t
+  max_rowid(sqlite3* db)
+  {
+    auto const stmt = prepare(db, "SELECT max(rowid) FROM ParameterSets;");
+    if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+      throwOnSQLiteFailure(db);
+    }
+    return sqlite3_column_int64(stmt.get(), 0); // 0 if the table is empty.
+  }
+
+  using fhicl::ParameterSet;
+  using fhicl::ParameterSetID;
+  using blob_format = fhicl::ParameterSetRegistry::blob_format;
+
+  ParameterSetID
+  id_column(sqlite3_stmt* stmt, int const column)
+  {
+    if (sqlite3_column_type(stmt, column) == SQLITE_BLOB &&
+        sqlite3_column_bytes(stmt, column) == cet::sha1::digest_sz) {
+      cet::sha1::digest_t digest;
+      std::memcpy(
+        digest.data(), sqlite3_column_blob(stmt, column), digest.size());
+      return ParameterSetID{digest};
+    }
+    return ParameterSetID{
+      reinterpret_cast<char const*>(sqlite3_column_text(stmt, column))};
+  }
+
+  ParameterSet
+  pset_column(sqlite3_stmt* stmt, int const column)
+  {
+    if (sqlite3_column_type(stmt, column) == SQLITE_BLOB) {
+      return fhicl::detail::binary_blob::decode(
+        {static_cast<char const*>(sqlite3_column_blob(stmt, column)),
+         static_cast<std::size_t>(sqlite3_column_bytes(stmt, column))});
+    }
+    return ParameterSet::make(
+      reinterpret_cast<char const*>(sqlite3_column_text(stmt, column)));
+  }
+
+  // A PSetBlob read from the DB, to be decoded later.
+  struct stored_blob {
+    std::string bytes;
+    bool binary;
+  };
+
+  stored_blob
+  blob_column(sqlite3_stmt* stmt, int const column)
+  {
+    if (sqlite3_column_type(stmt, column) == SQLITE_BLOB) {
+      return {{static_cast<char const*>(sqlite3_column_blob(stmt, column)),
+               static_cast<std::size_t>(sqlite3_column_bytes(stmt, column))},
+              true};
+    }
+    return {reinterpret_cast<char const*>(sqlite3_column_text(stmt, column)),
+            false};
+  }
+
+  ParameterSet
+  decode(stored_blob const& blob)
+  {
+    return blob.binary ? fhicl::detail::binary_blob::decode(blob.bytes) :
+                         ParameterSet::make(blob.bytes);
+  }
+
+  std::string
+  encode(ParameterSet const& ps, blob_format const format)
+  {
+    return format == blob_format::binary ?
+             fhicl::detail::binary_blob::encode(ps) :
+             ps.to_compact_string();
+  }
+
+  void
+  bind_id(sqlite3_stmt* stmt,
+          int const column,
+          ParameterSetID const& id,
+          blob_format const format)
+  {
+    if (format == blob_format::binary) {
+      auto const& digest = id.digest();
+      throwOnSQLiteFailure(sqlite3_bind_blob(
+        stmt, column, digest.data(), digest.size(), SQLITE_TRANSIENT));
+      return;
+    }
+    // As stored: including the terminating null character.
+    auto const idString = id.to_string();
+    throwOnSQLiteFailure(sqlite3_bind_text(stmt,
+                                           column,
+                                           idString.c_str(),
+                                           idString.size() + 1,
+                                           SQLITE_TRANSIENT));
+  }
+
+  // Text is stored including the terminating null character, whether
+  // or not the source has it.
+  void
+  bind_text_column(sqlite3_stmt* stmt,
+                   int const column,
+                   sqlite3_stmt* source,
+                   int const source_column)
+  {
+    auto const* text =
+      reinterpret_cast<char const*>(sqlite3_column_text(source, source_column));
+    throwOnSQLiteFailure(sqlite3_bind_text(
+      stmt, column, text, std::strlen(text) + 1, SQLITE_TRANSIENT));
+  }
+
+  void
+  bind_pset(sqlite3_stmt* stmt,
+            int const column,
+            std::string const& psBlob,
+            blob_format const format)
+  {
+    if (format == blob_format::binary) {
+      throwOnSQLiteFailure(sqlite3_bind_blob(
+        stmt, column, psBlob.data(), psBlob.size(), SQLITE_STATIC));
+      return;
+    }
+    throwOnSQLiteFailure(sqlite3_bind_text(
+      stmt, column, psBlob.c_str(), psBlob.size() + 1, SQLITE_STATIC));
+  }
 }
 
 void
@@ -64,7 +395,6 @@ fhicl::detail::throwOnSQLiteFailure(sqlite3* db, char* msg)
 
 fhicl::ParameterSetRegistry::~ParameterSetRegistry()
 {
-  sqlite3_finalize(stmt_);
   try {
     throwOnSQLiteFailure(primaryDB_);
   }
@@ -83,167 +413,1096 @@ void
 fhicl::ParameterSetRegistry::importFrom(sqlite3* db)
 {
   assert(db);
-  std::lock_guard sentry{mutex_};
+  db_lock sentry{mutex_};
+  stopwatch const watch;
 
   // This does *not* cause anything new to be imported into the
-  // registry itself, just its backing DB.
-  sqlite3_stmt* oStmt = nullptr;
+  // registry itself, just its backing DB.  The ParameterSets are
+  // copied as stored, in either format; the IDs are always stored as
+  // text.
   sqlite3* primaryDB = instance_().primaryDB_;
 
   // Index constraint on ID will prevent duplicates via INSERT OR IGNORE.
-  sqlite3_prepare_v2(
-    primaryDB,
-    "INSERT OR IGNORE INTO ParameterSets(ID, PSetBlob) VALUES(?, ?);",
-    -1,
-    &oStmt,
-    nullptr);
-  throwOnSQLiteFailure(primaryDB);
-
-  using namespace cet::sqlite;
-  query_result<std::string, std::string> inputPSes;
-  inputPSes << select("*").from(db, "ParameterSets");
-
-  for (auto const& [idString, psBlob] : inputPSes) {
-    sqlite3_bind_text(
-      oStmt, 1, idString.c_str(), idString.size() + 1, SQLITE_STATIC);
-    throwOnSQLiteFailure(primaryDB);
-    sqlite3_bind_text(
-      oStmt, 2, psBlob.c_str(), psBlob.size() + 1, SQLITE_STATIC);
-    throwOnSQLiteFailure(primaryDB);
-    switch (sqlite3_step(oStmt)) {
-    case SQLITE_DONE:
-      break; // OK
-    default:
-      throwOnSQLiteFailure(primaryDB);
+  cet::sqlite::Transaction txn{primaryDB};
+  auto const changes = sqlite3_total_changes(primaryDB);
+  auto const rows = prepare(db, "SELECT ID, PSetBlob FROM ParameterSets;");
+  auto const insert = prepare(primaryDB, insert_sql);
+  int rc;
+  while ((rc = sqlite3_step(rows.get())) == SQLITE_ROW) {
+    if (sqlite3_column_type(rows.get(), 0) == SQLITE_BLOB) {
+      bind_id(insert.get(), 1, id_column(rows.get(), 0), blob_format::text);
+    } else {
+      bind_text_column(insert.get(), 1, rows.get(), 0);
     }
-    sqlite3_reset(oStmt);
-    throwOnSQLiteFailure(primaryDB);
+    if (sqlite3_column_type(rows.get(), 1) == SQLITE_BLOB) {
+      throwOnSQLiteFailure(sqlite3_bind_value(
+        insert.get(), 2, sqlite3_column_value(rows.get(), 1)));
+    } else {
+      bind_text_column(insert.get(), 2, rows.get(), 1);
+    }
+    step_to_done(primaryDB, insert.get());
+  }
+  if (rc != SQLITE_DONE) {
+    throwOnSQLiteFailure(db);
   }
-  sqlite3_finalize(oStmt);
-  throwOnSQLiteFailure(primaryDB);
+  txn.commit();
+  s_counters.import_from.add(sqlite3_total_changes(primaryDB) - changes,
+                             watch.nanoseconds());
 }
 
 void
-fhicl::ParameterSetRegistry::exportTo(sqlite3* db)
+fhicl::ParameterSetRegistry::exportTo(sqlite3* db,
+                                      export_mode const mode,
+                                      blob_format const format)
 {
   assert(db);
-  std::lock_guard sentry{mutex_};
+  db_lock sentry{mutex_};
+  stopwatch const watch;
+
+  auto& registry = instance_();
+  registry.copy_mapped_files_();
+  sqlite3* const primaryDB{registry.primaryDB_};
+  auto const* name = sqlite3_db_filename(db, "main");
+  std::string const filename{name ? name : ""};
+  std::int64_t after{};
 
   cet::sqlite::Transaction txn{db};
-  cet::sqlite::exec(db,
-                    "DROP TABLE IF EXISTS ParameterSets;"
-                    "CREATE TABLE ParameterSets(ID PRIMARY KEY, PSetBlob);");
-  txn.commit();
+  auto const changes = sqlite3_total_changes(db);
+  if (mode == export_mode::full) {
+    cet::sqlite::exec(db,
+                      "DROP TABLE IF EXISTS ParameterSets;"
+                      "CREATE TABLE ParameterSets(ID PRIMARY KEY, PSetBlob);");
+  } else {
+    cet::sqlite::exec(db,
+                      "CREATE TABLE IF NOT EXISTS "
+                      "ParameterSets(ID PRIMARY KEY, PSetBlob);");
+    // Resume where the last export to this DB left off, unless its
+    // table has been changed since.
+    auto const& marks = registry.export_marks_;
+    if (auto it = marks.find(db); it != marks.cend() &&
+                                  it->second.filename == filename &&
+                                  it->second.target_rowid == max_rowid(db)) {
+      after = it->second.primary_rowid;
+    }
+  }
 
-  sqlite3_stmt* oStmt = nullptr;
-  sqlite3_prepare_v2(
-    db,
-    "INSERT OR IGNORE INTO ParameterSets(ID, PSetBlob) VALUES(?, ?);",
-    -1,
-    &oStmt,
-    nullptr);
-  throwOnSQLiteFailure(db);
-  for (auto const& p : instance_().registry_) {
-    std::string id(p.first.to_string());
-    std::string psBlob(p.second.to_compact_string());
-    sqlite3_bind_text(oStmt, 1, id.c_str(), id.size() + 1, SQLITE_STATIC);
-    throwOnSQLiteFailure(db);
-    sqlite3_bind_text(
-      oStmt, 2, psBlob.c_str(), psBlob.size() + 1, SQLITE_STATIC);
-    throwOnSQLiteFailure(db);
-    switch (sqlite3_step(oStmt)) {
-    case SQLITE_DONE:
-      sqlite3_reset(oStmt);
-      throwOnSQLiteFailure(db);
-      break; // OK
-    default:
-      throwOnSQLiteFailure(db);
+  {
+    // Rows already in the primary DB are copied as stored, unless they
+    // are in the other format.
+    auto const binary = format == blob_format::binary;
+    auto const rows = prepare(primaryDB,
+                              "SELECT ID, PSetBlob FROM ParameterSets "
+                              "WHERE rowid > ? ORDER BY rowid;");
+    auto const insert = prepare(db, insert_sql);
+    throwOnSQLiteFailure(sqlite3_bind_int64(rows.get(), 1, after));
+    int rc;
+    while ((rc = sqlite3_step(rows.get())) == SQLITE_ROW) {
+      if (binary) {
+        bind_id(insert.get(), 1, id_column(rows.get(), 0), format);
+      } else {
+        throwOnSQLiteFailure(sqlite3_bind_value(
+          insert.get(), 1, sqlite3_column_value(rows.get(), 0)));
+      }
+      std::string psBlob;
+      if (binary == (sqlite3_column_type(rows.get(), 1) == SQLITE_BLOB)) {
+        throwOnSQLiteFailure(sqlite3_bind_value(
+          insert.get(), 2, sqlite3_column_value(rows.get(), 1)));
+      } else {
+        // Converting a text row to binary registers the tables it
+        // inlines; they are written by sync_primaryDB_ below.
+        psBlob = encode(pset_column(rows.get(), 1), format);
+        bind_pset(insert.get(), 2, psBlob, format);
+      }
+      step_to_done(db, insert.get());
+    }
+    if (rc != SQLITE_DONE) {
+      throwOnSQLiteFailure(primaryDB);
     }
   }
+  // Entries registered since are written to both DBs.
+  registry.sync_primaryDB_(db, format);
 
-  sqlite3* const primaryDB{instance_().primaryDB_};
-  using namespace cet::sqlite;
-  query_result<std::string, std::string> regPSes;
-  regPSes << select("*").from(primaryDB, "ParameterSets");
+  export_mark mark{filename, max_rowid(db), max_rowid(primaryDB)};
+  auto const rows = sqlite3_total_changes(db) - changes;
+  txn.commit();
+  registry.export_marks_[db] = std::move(mark);
+  s_counters.export_to.add(rows, watch.nanoseconds());
+}
 
-  for (auto const& [idString, psBlob] : regPSes) {
-    sqlite3_bind_text(
-      oStmt, 1, idString.c_str(), idString.size() + 1, SQLITE_STATIC);
-    throwOnSQLiteFailure(db);
-    sqlite3_bind_text(
-      oStmt, 2, psBlob.c_str(), psBlob.size() + 1, SQLITE_STATIC);
-    throwOnSQLiteFailure(db);
-    switch (sqlite3_step(oStmt)) {
-    case SQLITE_DONE:
-      sqlite3_reset(oStmt);
-      throwOnSQLiteFailure(db);
-      break; // OK
-    default:
-      throwOnSQLiteFailure(db);
+// Converts each entry registered since the last call to its blob, and
+// adds it to the primary DB and, if given, the target DB -- unless it
+// is already in the primary DB (having been imported, or staged from
+// the DB).  Entries read from the DB or a mapped file are skipped
+// without being converted.
+void
+fhicl::ParameterSetRegistry::sync_primaryDB_(sqlite3* const target,
+                                             blob_format const format)
+{
+  auto const end = next_sequence_.load();
+  auto const log = log_between_(synced_sequence_, end);
+  if (!log.empty()) {
+    cet::sqlite::Transaction txn{primaryDB_};
+    auto const insert = prepare(primaryDB_, insert_sql);
+    auto const also_insert = target ? prepare(target, insert_sql) :
+                                      statement_ptr{nullptr, sqlite3_finalize};
+    for (auto const& record : log) {
+      if (record.stored) {
+        continue;
+      }
+      auto const& [id, ps] = *record.entry;
+      auto const psBlob = encode(ps, format);
+      bind_id(insert.get(), 1, id, blob_format::text);
+      bind_pset(insert.get(), 2, psBlob, format);
+      step_to_done(primaryDB_, insert.get());
+      if (also_insert == nullptr || sqlite3_changes(primaryDB_) == 0) {
+        continue; // If already in the primary DB, it has been copied.
+      }
+      bind_id(also_insert.get(), 1, id, format);
+      bind_pset(also_insert.get(), 2, psBlob, format);
+      step_to_done(target, also_insert.get());
     }
+    txn.commit();
   }
-  sqlite3_finalize(oStmt);
-  throwOnSQLiteFailure(db);
+  synced_sequence_ = end;
 }
 
+// The rows are read in chunks, each with the backing DB locked, and
+// then decoded concurrently without it: decoding a text blob registers
+// the tables it inlines, which may need the lock to evict entries.
+// The decoded ParameterSets of a chunk are then registered in the
+// order of the rows.
 void
 fhicl::ParameterSetRegistry::stageIn()
 {
-  std::lock_guard sentry{mutex_};
+  constexpr std::size_t chunk_size{4096};
 
-  sqlite3* primaryDB = instance_().primaryDB_;
-  auto& registry = instance_().registry_;
-  using namespace cet::sqlite;
-  query_result<std::string, std::string> entriesToStageIn;
-  entriesToStageIn << select("*").from(primaryDB, "ParameterSets");
+  stopwatch const watch;
+  std::uint64_t n{};
+  std::int64_t after{};
+  std::vector<std::pair<ParameterSetID, stored_blob>> rows;
+  std::vector<ParameterSet> psets;
+  do {
+    rows.clear();
+    {
+      db_lock sentry{mutex_};
+
+      sqlite3* primaryDB = instance_().primaryDB_;
+      auto const stmt = prepare(primaryDB,
+                                "SELECT rowid, ID, PSetBlob FROM ParameterSets "
+                                "WHERE rowid > ? ORDER BY rowid LIMIT ?;");
+      throwOnSQLiteFailure(sqlite3_bind_int64(stmt.get(), 1, after));
+      throwOnSQLiteFailure(sqlite3_bind_int64(stmt.get(), 2, chunk_size));
+      int rc;
+      while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+        after = sqlite3_column_int64(stmt.get(), 0);
+        rows.emplace_back(id_column(stmt.get(), 1),
+                          blob_column(stmt.get(), 2));
+      }
+      if (rc != SQLITE_DONE) {
+        throwOnSQLiteFailure(primaryDB);
+      }
+    }
+
+    psets.clear();
+    psets.resize(rows.size());
+    tbb::parallel_for(tbb::blocked_range<std::size_t>{0, rows.size()},
+                      [&rows, &psets](auto const& range) {
+                        for (auto i = range.begin(); i != range.end(); ++i) {
+                          psets[i] = decode(rows[i].second);
+                        }
+                      });
+    // Each shard is locked once per chunk rather than once per row, and
+    // the entries are recorded in the order of the rows.
+    std::array<bool, n_shards> involved{};
+    for (auto const& row : rows) {
+      involved[shard_index_(row.first)] = true;
+    }
+    auto& shards = instance_().shards_;
+    {
+      auto const sentries = lock_shards_(involved);
+      for (std::size_t i = 0; i != rows.size(); ++i) {
+        auto& s = shards[shard_index_(rows[i].first)];
+        auto const [it, inserted] =
+          s.entries.try_emplace(rows[i].first, std::move(psets[i]));
+        if (inserted) {
+          record_(s, *it, true);
+          s_counters.new_puts.add();
+        } else {
+          s_counters.duplicate_puts.add();
+        }
+      }
+    }
+    n += rows.size();
+  } while (rows.size() == chunk_size);
+  s_counters.stage_in.add(n, watch.nanoseconds());
+  if (over_capacity_()) {
+    evict_();
+  }
+}
+
+void
+fhicl::ParameterSetRegistry::exportToFile(std::string const& filename)
+{
+  db_lock sentry{mutex_};
+
+  auto& registry = instance_();
+  registry.copy_mapped_files_();
+  std::vector<std::pair<ParameterSetID, std::string>> entries;
+  std::int64_t after{};
+  // Converting text rows registers the tables they inline, which are
+  // then added to the primary DB by the next pass.
+  for (;;) {
+    registry.sync_primaryDB_(nullptr, blob_format::binary);
+    auto const before = entries.size();
+    auto const rows = prepare(registry.primaryDB_,
+                              "SELECT rowid, ID, PSetBlob FROM ParameterSets "
+                              "WHERE rowid > ? ORDER BY rowid;");
+    throwOnSQLiteFailure(sqlite3_bind_int64(rows.get(), 1, after));
+    int rc;
+    while ((rc = sqlite3_step(rows.get())) == SQLITE_ROW) {
+      after = sqlite3_column_int64(rows.get(), 0);
+      auto id = id_column(rows.get(), 1);
+      if (sqlite3_column_type(rows.get(), 2) == SQLITE_BLOB) {
+        auto const* data =
+          static_cast<char const*>(sqlite3_column_blob(rows.get(), 2));
+        entries.emplace_back(
+          std::move(id),
+          std::string(data, sqlite3_column_bytes(rows.get(), 2)));
+      } else {
+        entries.emplace_back(
+          std::move(id),
+          encode(pset_column(rows.get(), 2), blob_format::binary));
+      }
+    }
+    if (rc != SQLITE_DONE) {
+      throwOnSQLiteFailure(registry.primaryDB_);
+    }
+    if (entries.size() == before) {
+      break;
+    }
+  }
+  detail::mapped_registry_file::write(filename, std::move(entries));
+}
+
+void
+fhicl::ParameterSetRegistry::mapFile(std::string const& filename)
+{
+  auto file = std::make_unique<detail::mapped_registry_file>(filename);
+  db_lock sentry{mutex_};
+  instance_().mapped_files_.push_back(std::move(file));
+}
+
+void
+fhicl::ParameterSetRegistry::copy_mapped_files_()
+{
+  if (copied_mapped_files_ == mapped_files_.size()) {
+    return;
+  }
+  cet::sqlite::Transaction txn{primaryDB_};
+  auto const insert = prepare(primaryDB_, insert_sql);
+  for (; copied_mapped_files_ != mapped_files_.size(); ++copied_mapped_files_) {
+    auto const& file = *mapped_files_[copied_mapped_files_];
+    for (std::size_t i = 0, n = file.size(); i != n; ++i) {
+      auto const [id, blob] = file.entry(i);
+      bind_id(insert.get(), 1, id, blob_format::text);
+      throwOnSQLiteFailure(sqlite3_bind_blob(
+        insert.get(), 2, blob.data(), blob.size(), SQLITE_STATIC));
+      step_to_done(primaryDB_, insert.get());
+    }
+  }
+  txn.commit();
+}
 
-  cet::transform_all(entriesToStageIn,
-                     std::inserter(registry, std::begin(registry)),
-                     [](auto const& row) {
-                       auto const& [idString, psBlob] = row;
-                       auto const pset = ParameterSet::make(psBlob);
-                       return std::make_pair(ParameterSetID{idString}, pset);
-                     });
+bool
+fhicl::ParameterSetRegistry::empty()
+{
+  for (auto const& s : instance_().shards_) {
+    std::shared_lock sentry{s.mutex};
+    if (!s.entries.empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto
+fhicl::ParameterSetRegistry::size() -> size_type
+{
+  size_type result{};
+  for (auto const& s : instance_().shards_) {
+    std::shared_lock sentry{s.mutex};
+    result += s.entries.size();
+  }
+  return result;
+}
+
+void
+fhicl::ParameterSetRegistry::set_capacity(size_type const n)
+{
+  instance_().capacity_ = n;
+  if (over_capacity_()) {
+    evict_();
+  }
+}
+
+auto
+fhicl::ParameterSetRegistry::capacity() -> size_type
+{
+  return instance_().capacity_;
+}
+
+auto
+fhicl::ParameterSetRegistry::get() -> collection_type
+{
+  auto const entries = take_snapshot();
+  return collection_type(entries.begin(), entries.end());
 }
 
 fhicl::ParameterSetRegistry::ParameterSetRegistry()
   : primaryDB_{openPrimaryDB()}
 {}
 
+// ----------------------------------------------------------------------
+
+namespace {
+  struct pending_batch {
+    bool active{false};
+    fhicl::ParameterSetRegistry::collection_type entries;
+    std::vector<fhicl::ParameterSetID> order; // As put.
+  };
+
+  thread_local pending_batch t_pending;
+  thread_local fhicl::ParameterSetRegistry::pin_scope* t_pin_scope{nullptr};
+}
+
+fhicl::ParameterSetRegistry::batch::batch(bool const enable)
+  : previous_{t_pending.active}
+{
+  if (!enable) {
+    publish_pending_();
+  }
+  t_pending.active = enable;
+}
+
+void
+fhicl::ParameterSetRegistry::batch::publish()
+{
+  if (t_pending.active && !previous_) {
+    publish_pending_();
+  }
+}
+
+// Discards what was not published, without allocating.
+fhicl::ParameterSetRegistry::batch::~batch()
+{
+  if (t_pending.active && !previous_) {
+    t_pending.entries.clear();
+    t_pending.order.clear();
+    pending_usages_.clear();
+  }
+  t_pending.active = previous_;
+}
+
 auto
-fhicl::ParameterSetRegistry::find_(ParameterSetID const& id) -> const_iterator
+fhicl::ParameterSetRegistry::pending_() noexcept -> collection_type*
 {
-  // No lock here -- it was already acquired by get(...).
-  auto it = registry_.find(id);
-  if (it == registry_.cend()) {
-    // Look in primary DB for this ID and its contained IDs.
-    if (stmt_ == nullptr) {
-      sqlite3_prepare_v2(primaryDB_,
-                         "SELECT PSetBlob FROM ParameterSets WHERE ID = ?;",
-                         -1,
-                         &stmt_,
-                         nullptr);
-      throwOnSQLiteFailure(primaryDB_);
+  return t_pending.active ? &t_pending.entries : nullptr;
+}
+
+void
+fhicl::ParameterSetRegistry::publish_pending_()
+{
+  auto& entries = t_pending.entries;
+  if (entries.empty()) {
+    return;
+  }
+  // Splices the nodes, so references to buffered entries remain valid.
+  std::vector<collection_type::node_type> nodes;
+  nodes.reserve(entries.size());
+  std::array<bool, n_shards> involved{};
+  for (auto const& id : t_pending.order) {
+    involved[shard_index_(id)] = true;
+    nodes.push_back(entries.extract(id));
+  }
+  t_pending.order.clear();
+
+  // The entries are recorded in the order in which they were put, as
+  // seen by snapshots.
+  auto& shards = instance_().shards_;
+  {
+    auto const sentries = lock_shards_(involved);
+    auto& usages = pending_usages_;
+    for (auto& node : nodes) {
+      auto& s = shards[shard_index_(node.key())];
+      auto u =
+        usages.empty() ? usage_map::node_type{} : usages.extract(node.key());
+      auto result = s.entries.insert(std::move(node));
+      if (result.inserted) {
+        record_(s, *result.position, false, std::move(u));
+        s_counters.new_puts.add();
+        continue;
+      }
+      // Only entries to which handles were taken may still be referred
+      // to.
+      if (u) {
+        s.superseded.emplace_back(std::move(result.node), std::move(u));
+      }
+      s_counters.duplicate_puts.add();
     }
-    auto idString = id.to_string();
-    auto result = sqlite3_bind_text(
-      stmt_, 1, idString.c_str(), idString.size() + 1, SQLITE_STATIC);
-    throwOnSQLiteFailure(primaryDB_);
-    result = sqlite3_step(stmt_);
-    switch (result) {
-    case SQLITE_ROW: // Found the ID in the DB.
-    {
-      auto const pset = ParameterSet::make(
-        reinterpret_cast<char const*>(sqlite3_column_text(stmt_, 0)));
-      // Put into the registry without triggering ParameterSet::id().
-      it = registry_.emplace(id, pset).first;
-    } break;
-    case SQLITE_DONE:
-      break; // Not here.
-    default:
+    for (std::size_t i = 0; i != n_shards; ++i) {
+      if (involved[i]) {
+        release_superseded_(shards[i]);
+      }
+    }
+  }
+  if (over_capacity_()) {
+    evict_();
+  }
+}
+
+auto
+fhicl::ParameterSetRegistry::lock_shards_(
+  std::array<bool, n_shards> const& flags) -> shard_locks
+{
+  auto& shards = instance_().shards_;
+  shard_locks result;
+  for (std::size_t i = 0; i != n_shards; ++i) {
+    if (flags[i]) {
+      result[i] = std::unique_lock{shards[i].mutex};
+    }
+  }
+  return result;
+}
+
+auto
+fhicl::ParameterSetRegistry::pending_usage_(ParameterSetID const& id)
+  -> usage*
+{
+  // Recorded whatever the capacity, so that an entry superseded when
+  // it is published is kept only while it is pinned.
+  return &pending_usages_.try_emplace(id, 0).first->second;
+}
+
+void
+fhicl::ParameterSetRegistry::buffer_(ParameterSetID const& id,
+                                     ParameterSet const& ps)
+{
+  if (t_pending.entries.count(id) == 0) {
+    auto const& s = shard_for_(id);
+    std::shared_lock sentry{s.mutex};
+    if (s.entries.find(id) != s.entries.cend()) {
+      s_counters.duplicate_puts.add();
+      return;
+    }
+  }
+  if (t_pending.entries.try_emplace(id, ps).second) {
+    t_pending.order.push_back(id);
+  }
+}
+
+void
+fhicl::ParameterSetRegistry::insert_(ParameterSetID const& id,
+                                     ParameterSet const& ps,
+                                     bool const stored)
+{
+  emplace_(id, ps, stored);
+}
+
+void
+fhicl::ParameterSetRegistry::insert_(ParameterSetID const& id,
+                                     ParameterSet&& ps,
+                                     bool const stored)
+{
+  emplace_(id, std::move(ps), stored);
+}
+
+template <typename PS>
+void
+fhicl::ParameterSetRegistry::emplace_(ParameterSetID const& id,
+                                      PS&& ps,
+                                      bool const stored)
+{
+  auto& s = shard_for_(id);
+  {
+    // Most insertions are of entries that are already present.
+    std::shared_lock sentry{s.mutex};
+    if (s.entries.find(id) != s.entries.cend()) {
+      s_counters.duplicate_puts.add();
+      return;
+    }
+  }
+  std::lock_guard sentry{s.mutex};
+  auto const [it, inserted] = s.entries.try_emplace(id, std::forward<PS>(ps));
+  if (inserted) {
+    record_(s, *it, stored);
+    s_counters.new_puts.add();
+  } else {
+    s_counters.duplicate_puts.add();
+  }
+}
+
+void
+fhicl::ParameterSetRegistry::record_(shard& s,
+                                     value_type const& entry,
+                                     bool const stored,
+                                     usage_map::node_type pending)
+{
+  auto& registry = instance_();
+  auto const sequence = registry.next_sequence_++;
+  s.log.push_back({sequence, &entry, stored});
+  ++registry.size_;
+  if (pending) {
+    pending.mapped().sequence = sequence;
+    s.usages.insert(std::move(pending));
+  }
+  if (registry.capacity_.load(std::memory_order_relaxed) != 0) {
+    auto& u = s.usages.try_emplace(entry.first, sequence).first->second;
+    u.last_use = ++registry.clock_;
+  }
+}
+
+void
+fhicl::ParameterSetRegistry::release_superseded_(shard& s) noexcept
+{
+  auto& superseded = s.superseded;
+  superseded.erase(std::remove_if(superseded.begin(),
+                                  superseded.end(),
+                                  [](auto const& entry) {
+                                    return !pinned_(entry.second.mapped());
+                                  }),
+                   superseded.end());
+}
+
+auto
+fhicl::ParameterSetRegistry::touch_(shard& s, ParameterSetID const& id)
+  -> usage*
+{
+  if (s.usages.empty()) {
+    return nullptr;
+  }
+  auto it = s.usages.find(id);
+  if (it == s.usages.end()) {
+    return nullptr;
+  }
+  it->second.last_use = ++clock_;
+  return &it->second;
+}
+
+void
+fhicl::ParameterSetRegistry::retain_(handle const& h)
+{
+  if (t_pin_scope != nullptr) {
+    t_pin_scope->pins_.push_back(h);
+  } else {
+    h.usage_->retained = instance_().epoch_.load();
+  }
+}
+
+bool
+fhicl::ParameterSetRegistry::pinned_(usage const& u) noexcept
+{
+  return u.pins != 0 || u.retained == instance_().epoch_.load();
+}
+
+auto
+fhicl::ParameterSetRegistry::log_between_(std::uint64_t const begin,
+                                          std::uint64_t const end,
+                                          std::vector<handle>* const pins)
+  -> log_type
+{
+  log_type result;
+  for (auto& s : shards_) {
+    std::shared_lock sentry{s.mutex};
+    auto it = std::lower_bound(
+      s.log.cbegin(), s.log.cend(), begin, [](auto const& record, auto seq) {
+        return record.sequence < seq;
+      });
+    for (; it != s.log.cend() && it->sequence < end; ++it) {
+      result.push_back(*it);
+      if (pins == nullptr || s.usages.empty()) {
+        continue;
+      }
+      if (auto u = s.usages.find(it->entry->first); u != s.usages.end()) {
+        pins->push_back(handle{it->entry, &u->second});
+      }
+    }
+  }
+  std::sort(
+    result.begin(), result.end(), [](auto const& a, auto const& b) {
+      return a.sequence < b.sequence;
+    });
+  return result;
+}
+
+auto
+fhicl::ParameterSetRegistry::take_snapshot() -> snapshot
+{
+  // Every entry with a lower sequence number is already in its shard,
+  // or will be once the shard's lock is released.
+  auto& registry = instance_();
+  std::vector<handle> pins;
+  auto const log =
+    registry.log_between_(0, registry.next_sequence_.load(), &pins);
+  std::vector<value_type const*> entries;
+  entries.reserve(log.size());
+  for (auto const& record : log) {
+    entries.push_back(record.entry);
+  }
+  return snapshot{std::move(entries), std::move(pins)};
+}
+
+// Evicts the least recently used entries that are neither pinned nor
+// retained in the current epoch, down to 7/8 of the capacity so that
+// not every put evicts.  Only entries already in the backing DB (or
+// read from a mapped file) are evicted, so that they can be staged
+// again.
+void
+fhicl::ParameterSetRegistry::evict_()
+{
+  // A thread holding the lock on the backing DB may be converting
+  // entries to blobs.
+  if (t_db_depth != 0) {
+    return;
+  }
+  auto& registry = instance_();
+  std::unique_lock evicting{registry.eviction_mutex_, std::try_to_lock};
+  if (!evicting) {
+    return; // Another thread is evicting.
+  }
+  db_lock sentry{mutex_};
+  registry.sync_primaryDB_();
+
+  auto const capacity = registry.capacity_.load();
+  auto const size = registry.size_.load();
+  if (capacity == 0 || size <= capacity) {
+    return;
+  }
+  struct candidate {
+    std::uint64_t last_use;
+    std::size_t shard;
+    ParameterSetID id;
+  };
+  std::vector<candidate> candidates;
+  for (std::size_t i = 0; i != n_shards; ++i) {
+    auto const& s = registry.shards_[i];
+    std::shared_lock lock{s.mutex};
+    for (auto const& [id, u] : s.usages) {
+      if (!pinned_(u) && u.sequence < registry.synced_sequence_) {
+        candidates.push_back({u.last_use, i, id});
+      }
+    }
+  }
+  auto const n =
+    std::min<std::size_t>(size - (capacity - capacity / 8), candidates.size());
+  auto const by_last_use = [](auto const& a, auto const& b) {
+    return a.last_use < b.last_use;
+  };
+  std::nth_element(candidates.begin(),
+                   candidates.begin() + n,
+                   candidates.end(),
+                   by_last_use);
+  candidates.resize(n);
+  std::sort(candidates.begin(),
+            candidates.end(),
+            [](auto const& a, auto const& b) { return a.shard < b.shard; });
+
+  std::vector<std::uint64_t> evicted;
+  for (auto it = candidates.cbegin(), e = candidates.cend(); it != e;) {
+    auto& s = registry.shards_[it->shard];
+    std::lock_guard lock{s.mutex};
+    evicted.clear();
+    for (auto const shard = it->shard; it != e && it->shard == shard; ++it) {
+      // Pins are only added with the shard locked.
+      auto u = s.usages.find(it->id);
+      if (u == s.usages.end() || pinned_(u->second)) {
+        continue;
+      }
+      evicted.push_back(u->second.sequence);
+      s.usages.erase(u);
+      s.entries.erase(it->id);
+    }
+    std::sort(evicted.begin(), evicted.end());
+    s.log.erase(std::remove_if(s.log.begin(),
+                               s.log.end(),
+                               [&evicted](auto const& record) {
+                                 return std::binary_search(evicted.cbegin(),
+                                                           evicted.cend(),
+                                                           record.sequence);
+                               }),
+                s.log.end());
+    registry.size_ -= evicted.size();
+  }
+  // References returned by 'get' outside a pin_scope so far may now be
+  // invalidated by the next pass.
+  ++registry.epoch_;
+}
+
+auto
+fhicl::ParameterSetRegistry::stats() -> statistics
+{
+  return {stats_enabled,
+          s_counters.new_puts.load(),
+          s_counters.duplicate_puts.load(),
+          s_counters.lookups.load(),
+          s_counters.db_lookups.load(),
+          s_counters.lock_waits.load(),
+          s_counters.stage_in.load(),
+          s_counters.import_from.load(),
+          s_counters.export_to.load()};
+}
+
+void
+fhicl::ParameterSetRegistry::reset_stats()
+{
+  s_counters.new_puts.reset();
+  s_counters.duplicate_puts.reset();
+  s_counters.lookups.reset();
+  s_counters.db_lookups.reset();
+  s_counters.lock_waits.reset();
+  s_counters.stage_in.reset();
+  s_counters.import_from.reset();
+  s_counters.export_to.reset();
+}
+
+void
+fhicl::ParameterSetRegistry::add_root(ParameterSetID const& id)
+{
+  db_lock sentry{mutex_};
+  ++instance_().roots_[id];
+}
+
+void
+fhicl::ParameterSetRegistry::remove_root(ParameterSetID const& id)
+{
+  db_lock sentry{mutex_};
+  auto& roots = instance_().roots_;
+  if (auto it = roots.find(id); it != roots.end() && --it->second == 0) {
+    roots.erase(it);
+  }
+}
+
+// Traces the tables reachable from the roots, the anchors and the
+// pinned entries, staging those that are not registered, then drops
+// the other entries registered before the collection started, and
+// deletes their rows from the backing DB.  The entries of mapped
+// files are first copied to the backing DB so that the unreachable
+// ones are not exported.
+auto
+fhicl::ParameterSetRegistry::collect_garbage() -> size_type
+{
+  auto& registry = instance_();
+  size_type result{};
+  {
+    db_lock sentry{mutex_};
+    if (registry.roots_.empty()) {
+      return 0;
+    }
+    auto const end = registry.next_sequence_.load();
+    registry.copy_mapped_files_();
+
+    std::vector<ParameterSetID> wanted;
+    for (auto const& [id, count] : registry.roots_) {
+      wanted.push_back(id);
+    }
+    for (auto const& [id, count] : registry.anchors_) {
+      wanted.push_back(id);
+    }
+    for (auto const& s : registry.shards_) {
+      std::shared_lock lock{s.mutex};
+      for (auto const& [id, u] : s.usages) {
+        if (pinned_(u)) {
+          wanted.push_back(id);
+        }
+      }
+    }
+    std::unordered_set<ParameterSetID, detail::HashParameterSetID> reachable;
+    std::vector<ParameterSetID> children;
+    while (!wanted.empty()) {
+      auto const id = wanted.back();
+      wanted.pop_back();
+      if (!reachable.insert(id).second) {
+        continue;
+      }
+      auto const table = registry.find_(id);
+      if (!table) {
+        continue;
+      }
+      children.clear();
+      table->collect_table_ids_(children);
+      for (auto const& child : children) {
+        if (reachable.count(child) == 0) {
+          wanted.push_back(child);
+        }
+      }
+    }
+
+    for (auto& s : registry.shards_) {
+      std::lock_guard lock{s.mutex};
+      release_superseded_(s);
+      log_type kept;
+      kept.reserve(s.log.size());
+      for (auto const& record : s.log) {
+        auto const id = record.entry->first;
+        auto const u = s.usages.find(id);
+        // Entries registered, or pinned, since the trace are kept, and
+        // so are their rows.
+        if (record.sequence >= end || reachable.count(id) != 0 ||
+            (u != s.usages.end() && pinned_(u->second))) {
+          reachable.insert(id);
+          kept.push_back(record);
+          continue;
+        }
+        if (u != s.usages.end()) {
+          s.usages.erase(u);
+        }
+        s.entries.erase(id);
+        ++result;
+      }
+      s.log = std::move(kept);
+    }
+    registry.size_ -= result;
+
+    sqlite3* const primaryDB = registry.primaryDB_;
+    auto const last_rowid = max_rowid(primaryDB);
+    std::vector<std::int64_t> rowids;
+    {
+      auto const rows =
+        prepare(primaryDB, "SELECT rowid, ID FROM ParameterSets;");
+      int rc;
+      while ((rc = sqlite3_step(rows.get())) == SQLITE_ROW) {
+        if (reachable.count(id_column(rows.get(), 1)) == 0) {
+          rowids.push_back(sqlite3_column_int64(rows.get(), 0));
+        }
+      }
+      if (rc != SQLITE_DONE) {
+        throwOnSQLiteFailure(primaryDB);
+      }
+    }
+    if (!rowids.empty()) {
+      cet::sqlite::Transaction txn{primaryDB};
+      auto const erase =
+        prepare(primaryDB, "DELETE FROM ParameterSets WHERE rowid = ?;");
+      for (auto const rowid : rowids) {
+        throwOnSQLiteFailure(sqlite3_bind_int64(erase.get(), 1, rowid));
+        step_to_done(primaryDB, erase.get());
+      }
+      txn.commit();
+      registry.rows_deleted_ = true;
+      // Rowids may now be reused, so exports cannot resume from them.
+      if (max_rowid(primaryDB) < last_rowid) {
+        registry.export_marks_.clear();
+      }
+    }
+  }
+  if (over_capacity_()) {
+    evict_();
+  }
+  return result;
+}
+
+fhicl::ParameterSetRegistry::anchor::anchor(ParameterSetID const& id)
+  : handle_{acquire(id)}
+{
+  hold_();
+}
+
+fhicl::ParameterSetRegistry::anchor::anchor(anchor const& other)
+  : handle_{other.handle_}
+{
+  hold_();
+}
+
+fhicl::ParameterSetRegistry::anchor::~anchor()
+{
+  if (!handle_) {
+    return;
+  }
+  db_lock sentry{mutex_};
+  auto& anchors = instance_().anchors_;
+  if (auto it = anchors.find(handle_.id());
+      it != anchors.end() && --it->second == 0) {
+    anchors.erase(it);
+  }
+}
+
+void
+fhicl::ParameterSetRegistry::anchor::hold_()
+{
+  if (handle_) {
+    db_lock sentry{mutex_};
+    ++instance_().anchors_[handle_.id()];
+  }
+}
+
+fhicl::ParameterSetRegistry::pin_scope::pin_scope() noexcept
+  : previous_{std::exchange(t_pin_scope, this)}
+{}
+
+fhicl::ParameterSetRegistry::pin_scope::~pin_scope()
+{
+  t_pin_scope = previous_;
+}
+
+fhicl::ParameterSetRegistry::snapshot::snapshot(
+  std::vector<value_type const*> entries,
+  std::vector<handle> pins) noexcept
+  : entries_{std::move(entries)}, pins_{std::move(pins)}
+{}
+
+bool
+fhicl::ParameterSetRegistry::snapshot::empty() const noexcept
+{
+  return entries_.empty();
+}
+
+auto
+fhicl::ParameterSetRegistry::snapshot::size() const noexcept -> size_type
+{
+  return entries_.size();
+}
+
+auto
+fhicl::ParameterSetRegistry::snapshot::begin() const noexcept
+  -> const_iterator
+{
+  return const_iterator{entries_.cbegin()};
+}
+
+auto
+fhicl::ParameterSetRegistry::snapshot::end() const noexcept -> const_iterator
+{
+  return const_iterator{entries_.cend()};
+}
+
+auto
+fhicl::ParameterSetRegistry::find_registered_(ParameterSetID const& id)
+  -> handle
+{
+  auto& s = shard_for_(id);
+  std::shared_lock sentry{s.mutex};
+  if (auto it = s.entries.find(id); it != s.entries.cend()) {
+    return handle{&*it, touch_(s, id)};
+  }
+  return {};
+}
+
+auto
+fhicl::ParameterSetRegistry::find_(ParameterSetID const& id) -> handle
+{
+  s_counters.lookups.add();
+  if (auto result = find_registered_(id)) {
+    return result;
+  }
+
+  stopwatch const watch;
+  for (;;) {
+    // The shard must not be locked while staging, as making the
+    // ParameterSets registers their nested tables.
+    if (!materialize_(id) && !stage_subtree_(id)) {
+      s_counters.db_lookups.add(watch.nanoseconds());
+      return {};
+    }
+    // Otherwise, another thread evicted it in the meantime.
+    if (auto result = find_registered_(id)) {
+      s_counters.db_lookups.add(watch.nanoseconds());
+      if (over_capacity_()) {
+        evict_();
+      }
+      return result;
+    }
+  }
+}
+
+bool
+fhicl::ParameterSetRegistry::materialize_(ParameterSetID const& id)
+{
+  std::optional<std::string_view> blob;
+  bool stored{};
+  {
+    db_lock sentry{mutex_};
+    for (auto const& file : mapped_files_) {
+      if ((blob = file->find(id))) {
+        break;
+      }
+    }
+    stored = !rows_deleted_;
+  }
+  // Mapped files stay mapped for the lifetime of the registry.
+  if (!blob) {
+    return false;
+  }
+  insert_(id, detail::binary_blob::decode(*blob), stored);
+  return true;
+}
+
+// Stages the ParameterSet with the given ID from the primary DB,
+// together with all of its descendants that are not yet registered.
+// The tables referenced by the ParameterSets of one level of nesting
+// are selected with a single query, so a subtree costs one query per
+// level rather than one per table.  Returns false if the ID is not in
+// the DB.
+bool
+fhicl::ParameterSetRegistry::stage_subtree_(ParameterSetID const& id)
+{
+  std::vector<std::pair<ParameterSetID, ParameterSet>> staged;
+  std::set<ParameterSetID> requested{id};
+  std::vector<ParameterSetID> wanted{id};
+  while (!wanted.empty()) {
+    auto rows = select_psets_(wanted);
+    wanted.clear();
+    std::vector<ParameterSetID> children;
+    for (auto& [rowID, pset] : rows) {
+      children.clear();
+      pset.collect_table_ids_(children);
+      for (auto const& child : children) {
+        if (requested.insert(child).second && !has(child)) {
+          wanted.push_back(child);
+        }
+      }
+      staged.emplace_back(rowID, std::move(pset));
+    }
+  }
+  if (staged.empty()) {
+    return false;
+  }
+  // Register the most deeply nested tables first, as they would have
+  // been when the ParameterSet was made.  The IDs are taken from the
+  // DB, so ParameterSet::id() is not triggered.
+  for (auto it = staged.crbegin(), e = staged.crend(); it != e; ++it) {
+    insert_(it->first, it->second, true);
+  }
+  return true;
+}
+
+auto
+fhicl::ParameterSetRegistry::select_psets_(
+  std::vector<ParameterSetID> const& ids)
+  -> std::vector<std::pair<ParameterSetID, ParameterSet>>
+{
+  // Stay well below SQLite's limit on the number of host parameters.
+  constexpr std::size_t max_parameters{500};
+
+  std::vector<std::pair<ParameterSetID, ParameterSet>> result;
+  db_lock sentry{mutex_};
+  for (std::size_t b = 0; b < ids.size(); b += max_parameters) {
+    auto const n = std::min(max_parameters, ids.size() - b);
+    std::string sql{"SELECT ID, PSetBlob FROM ParameterSets WHERE ID IN (?"};
+    for (std::size_t i = 1; i != n; ++i) {
+      sql += ",?";
+    }
+    sql += ");";
+    auto const stmt = prepare(primaryDB_, sql.c_str());
+    for (std::size_t i = 0; i != n; ++i) {
+      bind_id(stmt.get(), i + 1, ids[b + i], blob_format::text);
+    }
+    int rc;
+    while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+      result.emplace_back(id_column(stmt.get(), 0),
+                          pset_column(stmt.get(), 1));
+    }
+    if (rc != SQLITE_DONE) {
       throwOnSQLiteFailure(primaryDB_);
     }
-    sqlite3_reset(stmt_);
   }
-  return it;
+  return result;
 }
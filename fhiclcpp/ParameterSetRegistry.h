@@ -5,18 +5,95 @@
 //
 // ParameterSetRegistry
 //
+// The registered ParameterSets are distributed over a fixed number of
+// shards according to their IDs, each shard guarded by its own
+// reader-writer lock.  Looking up an entry that is already present
+// takes only a shared lock on one shard, so concurrent readers do not
+// serialize, and insertions block only the readers of the same shard.
+// Entries are never moved and, unless a capacity is set, never
+// removed, so references returned by 'get' remain valid for the
+// lifetime of the registry.
+//
+// Setting a capacity bounds the number of registered entries: once it
+// is exceeded, the least recently looked-up entries are written to the
+// backing DB and evicted, to be staged again when next looked up.
+// Entries registered before a capacity is first set are never evicted.
+// An entry is not evicted while a 'handle' to it, as returned by
+// 'acquire', or a pin obtained from one (as held by a ValueView of a
+// nested table) exists.  A reference returned by 'get' pins the entry
+// until the innermost 'pin_scope' on the calling thread ends or, if
+// there is none, through the next eviction pass only, so that such
+// look-ups do not defeat the capacity; a reference to be held for
+// longer should be obtained within a 'pin_scope', or through a handle.
+//
+// The backing DB is guarded by a separate lock.  'importFrom' only
+// copies the stored ParameterSets into the backing DB, without parsing
+// them.  They are then parsed either all at once, concurrently, by
+// 'stageIn', or on demand: looking up an ID that is not yet registered
+// stages it together with all the tables it (transitively) refers to.
+//
+// Alternatively, a registry file written by 'exportToFile' may be
+// mapped into memory by 'mapFile', so that processes running the same
+// configuration share a single copy of it through the page cache.
+// Looking up an ID that is not yet registered then finds it in the
+// mapped file and registers it (materializing only that table; nested
+// tables are materialized when they are looked up in turn).
+//
+// Garbage collection drops the entries that are not reachable from any
+// of the registered roots, following the tables referred to by tables
+// and sequences, from the registry and from the backing DB, so that
+// they are not exported either.  Pinned entries, and those held by an
+// 'anchor' (as delegated parameters hold their enclosing tables), are
+// kept, together with the tables they refer to.  References to the
+// entries dropped, and snapshots holding them, are invalidated, so
+// 'collect_garbage' should be called between units of work (e.g. input
+// files), while no other thread is putting or looking up
+// ParameterSets.  If no roots
+// are registered, nothing is collected, whatever the anchors.
+//
+// A 'snapshot' of the registry may be iterated while other threads
+// continue to put entries.
+//
+// The ParameterSets table holds one row per ParameterSet, in either of
+// two formats, which may be mixed and are told apart row by row: the
+// ID as hex TEXT and the ParameterSet as its compact string, or the ID
+// as a 20-byte BLOB and the ParameterSet in the binary encoding of
+// detail/binary_blob.h, which is read without the FHiCL parser.
+//
+// Each registered ParameterSet is converted to its blob at most once:
+// the first export adds it to the backing DB, and every export then
+// copies rows of the backing DB, within a single transaction on the
+// target DB.  An incremental export writes only the rows added to the
+// backing DB since the last export to the same DB, provided that DB's
+// ParameterSets table has not been changed by anyone else in between;
+// otherwise, it writes all rows not yet present.  Rows stored in the
+// other format than the one requested are converted on each export.
+//
 // ======================================================================
 
 #include "fhiclcpp/ParameterSet.h"
 #include "fhiclcpp/ParameterSetID.h"
+#include "fhiclcpp/detail/registry_pin.h"
 #include "fhiclcpp/exception.h"
 #include "fhiclcpp/fwd.h"
 
+#include "boost/iterator/indirect_iterator.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 struct sqlite3;
-struct sqlite3_stmt;
 
 namespace fhicl {
 
@@ -24,21 +101,27 @@ namespace fhicl {
 
   namespace detail {
     class HashParameterSetID;
+    class mapped_registry_file;
     void throwOnSQLiteFailure(int rc, char* msg = nullptr);
     void throwOnSQLiteFailure(sqlite3* db, char* msg = nullptr);
   }
 }
 
+// Hashes the raw digest; no string conversion is involved.
 class fhicl::detail::HashParameterSetID {
 public:
-  size_t operator()(ParameterSetID const& id) const;
-
-private:
-  std::hash<std::string> hash_;
+  size_t operator()(ParameterSetID const& id) const noexcept;
 };
 
 class fhicl::ParameterSetRegistry {
 public:
+  class anchor;
+  class batch;
+  class handle;
+  class pin_scope;
+  class snapshot;
+  struct statistics;
+
   ParameterSetRegistry(ParameterSet const&) = delete;
   ParameterSetRegistry(ParameterSet&&) = delete;
   ParameterSetRegistry& operator=(ParameterSet const&) = delete;
@@ -55,17 +138,44 @@ public:
   using const_iterator = collection_type::const_iterator;
 
   // DB interaction.
+  enum class export_mode {
+    full,       // Replace the DB's ParameterSets table.
+    incremental // Add the entries not yet exported to the DB.
+  };
+  enum class blob_format { text, binary };
   static void importFrom(sqlite3* db);
-  static void exportTo(sqlite3* db);
+  static void exportTo(sqlite3* db,
+                       export_mode mode = export_mode::full,
+                       blob_format format = blob_format::text);
   static void stageIn();
 
+  // Registry files.  The file written includes the backing DB.
+  static void exportToFile(std::string const& filename);
+  static void mapFile(std::string const& filename);
+
   // Observers.
   static bool empty();
   static size_type size();
 
+  // Capacity, in number of entries; 0 (the default) is unbounded.
+  static void set_capacity(size_type n);
+  static size_type capacity();
+
+  // Garbage collection.  Roots are counted: each call to 'add_root'
+  // must be matched by one to 'remove_root'.  Returns the number of
+  // entries dropped from the registry.
+  static void add_root(ParameterSetID const& id);
+  static void remove_root(ParameterSetID const& id);
+  static size_type collect_garbage();
+
+  // Statistics.
+  static statistics stats();
+  static void reset_stats();
+
   // Put:
-  // 1. A single ParameterSet.
-  static ParameterSetID const& put(ParameterSet const& ps);
+  // 1. A single ParameterSet.  The ID is returned by value, as the
+  // entry may be evicted.
+  static ParameterSetID put(ParameterSet const& ps);
   // 2. A range of iterator to ParameterSet.
   template <class FwdIt>
   static std::enable_if_t<
@@ -84,43 +194,332 @@ public:
   static void put(collection_type const& c);
 
   // Accessors.
-  static collection_type const& get() noexcept;
+  // Returns a deep copy of all registered entries: every ParameterSet
+  // is copied, at a cost proportional to the size of the registry.
+  // 'take_snapshot' gives access to the same entries without copying
+  // them.
+  static collection_type get();
+  static snapshot take_snapshot();
+  static handle acquire(ParameterSetID const& id);
+  // Outside a 'pin_scope', the reference may be invalidated by any
+  // eviction but the next one.
   static ParameterSet const& get(ParameterSetID const& id);
   static bool get(ParameterSetID const& id, ParameterSet& ps);
   static bool has(ParameterSetID const& id);
 
 private:
+  // Recorded for each entry registered while a capacity is set, and
+  // for each entry buffered by a batch to which a handle is taken.
+  // Pins are only added with the entry's shard locked (or, while it is
+  // buffered, by the thread that buffered it).
+  struct usage {
+    explicit usage(std::uint64_t const seq) noexcept : sequence{seq} {}
+    std::uint64_t sequence; // Set when the entry is registered.
+    std::atomic<std::uint64_t> last_use{};
+    std::atomic<std::uint32_t> pins{};
+    // The eviction epoch in which a reference to the entry was last
+    // returned by 'get' outside a 'pin_scope'.
+    std::atomic<std::uint64_t> retained{};
+  };
+  using usage_map =
+    std::unordered_map<ParameterSetID, usage, detail::HashParameterSetID>;
+  // The insertion log records each entry with its registration
+  // sequence number, in increasing order, and whether it was read from
+  // the backing DB or a mapped file (and so need not be written back).
+  struct log_record {
+    std::uint64_t sequence;
+    value_type const* entry;
+    bool stored;
+  };
+  using log_type = std::vector<log_record>;
+  struct shard {
+    mutable std::shared_mutex mutex;
+    collection_type entries;
+    usage_map usages;
+    log_type log;
+    // Buffered entries to which handles were taken, but that another
+    // thread registered before they were published, with their usages.
+    // Each is kept until it is no longer pinned.
+    std::vector<std::pair<collection_type::node_type, usage_map::node_type>>
+      superseded;
+  };
+  static constexpr std::size_t n_shards{64};
+  // Where the last export to a DB left off: the largest rowid of the
+  // DB's ParameterSets table, and that of the backing DB.
+  struct export_mark {
+    std::string filename;
+    std::int64_t target_rowid;
+    std::int64_t primary_rowid;
+  };
+
+  using shard_locks =
+    std::array<std::unique_lock<std::shared_mutex>, n_shards>;
+
   ParameterSetRegistry();
   static ParameterSetRegistry& instance_();
-  const_iterator find_(ParameterSetID const& id);
+  static std::size_t shard_index_(ParameterSetID const& id) noexcept;
+  static shard& shard_for_(ParameterSetID const& id) noexcept;
+  // Locks the shards flagged for writing, all at once and in a fixed
+  // order (to avoid deadlock), so that a group of entries can be
+  // recorded in the order given.
+  static shard_locks lock_shards_(std::array<bool, n_shards> const& flags);
+  static void insert_(ParameterSetID const& id,
+                      ParameterSet const& ps,
+                      bool stored = false);
+  static void insert_(ParameterSetID const& id,
+                      ParameterSet&& ps,
+                      bool stored);
+  template <typename PS>
+  static void emplace_(ParameterSetID const& id, PS&& ps, bool stored);
+  // Falls back to materializing the entry from a mapped file, or
+  // staging it (and its descendants) from the primary DB.  Returns an
+  // empty handle if the ID is not found.
+  handle find_(ParameterSetID const& id);
+  // Looks only among the registered entries.
+  handle find_registered_(ParameterSetID const& id);
+  bool materialize_(ParameterSetID const& id);
+  // Copies the entries of the files mapped since the last call to the
+  // primary DB.  Must be called with mutex_ held.
+  void copy_mapped_files_();
+  bool stage_subtree_(ParameterSetID const& id);
+  std::vector<std::pair<ParameterSetID, ParameterSet>> select_psets_(
+    std::vector<ParameterSetID> const& ids);
+  // Must be called with the shard locked for writing.  The usage of a
+  // buffered entry, if any, is adopted.
+  static void record_(shard& s,
+                      value_type const& entry,
+                      bool stored,
+                      usage_map::node_type pending = {});
+  // Drops the superseded entries that are no longer pinned.  Must be
+  // called with the shard locked for writing.
+  static void release_superseded_(shard& s) noexcept;
+  // The records with sequence numbers in [begin, end), in order.  If
+  // 'pins' is given, the entries that may be evicted are pinned.
+  log_type log_between_(std::uint64_t begin,
+                        std::uint64_t end,
+                        std::vector<handle>* pins = nullptr);
+  // Marks the entry as used.  Must be called with the shard locked.
+  usage* touch_(shard& s, ParameterSetID const& id);
+  // Keeps the entry pinned for as long as the reference returned by
+  // 'get' may be used.
+  static void retain_(handle const& h);
+  // Whether the entry is pinned, or retained in the current epoch.
+  static bool pinned_(usage const& u) noexcept;
+  static bool over_capacity_() noexcept;
+  static void evict_();
+  // Adds the entries registered since the last call to the backing DB
+  // (and the target DB, if any).  Must be called with mutex_ held.
+  void sync_primaryDB_(sqlite3* target = nullptr,
+                       blob_format format = blob_format::text);
+
+  // The calling thread's batch, if one is being collected.
+  static collection_type* pending_() noexcept;
+  // The usage through which a buffered entry is pinned.
+  static usage* pending_usage_(ParameterSetID const& id);
+  // Entries already registered are not buffered.
+  static void buffer_(ParameterSetID const& id, ParameterSet const& ps);
+  static void publish_pending_();
 
   sqlite3* primaryDB_;
-  sqlite3_stmt* stmt_{nullptr};
-  collection_type registry_{};
+  std::array<shard, n_shards> shards_{};
+  std::atomic<std::uint64_t> next_sequence_{};
+  std::atomic<size_type> size_{};
+  std::atomic<size_type> capacity_{};
+  std::atomic<std::uint64_t> clock_{};
+  // Advanced by each eviction pass.
+  std::atomic<std::uint64_t> epoch_{1};
+  std::mutex eviction_mutex_;
+  // The following are guarded by mutex_, as is the backing DB.
+  std::uint64_t synced_sequence_{};
+  std::map<sqlite3*, export_mark> export_marks_;
+  std::vector<std::unique_ptr<detail::mapped_registry_file>> mapped_files_;
+  std::size_t copied_mapped_files_{};
+  std::unordered_map<ParameterSetID, std::size_t, detail::HashParameterSetID>
+    roots_;
+  std::unordered_map<ParameterSetID, std::size_t, detail::HashParameterSetID>
+    anchors_;
+  // Whether garbage collection has deleted rows of the backing DB, so
+  // that entries materialized from mapped files may be missing from it.
+  bool rows_deleted_{false};
   static std::recursive_mutex mutex_;
+  // The usages of the entries buffered by the calling thread's batch.
+  static thread_local usage_map pending_usages_;
 };
 
-inline bool
-fhicl::ParameterSetRegistry::empty()
-{
-  std::lock_guard sentry{mutex_};
-  return instance_().registry_.empty();
-}
+// While a 'batch' object exists, the ParameterSets put into the
+// registry by the thread that created it are collected in a
+// thread-local buffer instead, and published, in the order in which
+// they were put, when 'publish' is called on the outermost batch
+// object.  Until then, only 'put', 'has', 'acquire', and the single-ID
+// 'get' functions called from that thread see the buffered entries.
+// ParameterSets already registered are not buffered, and handles and
+// references to buffered entries remain valid once these are
+// published, the handles still pinning them.  Entries still buffered
+// when the outermost batch object is destroyed (e.g. while unwinding
+// from a failure) are discarded, so handles and references to them
+// must not outlive it.  Creating a batch object with 'enable == false'
+// publishes any pending entries and suspends batching on the thread
+// for the object's lifetime; this is required if other threads will
+// look up entries put by this one (e.g. for TBB tasks) before the
+// batch is published.
+class fhicl::ParameterSetRegistry::batch {
+public:
+  explicit batch(bool enable = true);
+  ~batch();
 
-inline auto
-fhicl::ParameterSetRegistry::size() -> size_type
-{
-  std::lock_guard sentry{mutex_};
-  return instance_().registry_.size();
-}
+  // Publishes the entries buffered so far, if this is the outermost
+  // batch; otherwise, that is left to the outermost one.
+  void publish();
+
+  batch(batch const&) = delete;
+  batch& operator=(batch const&) = delete;
+
+private:
+  bool previous_;
+};
+
+// A handle refers to a registered entry (or one buffered by the
+// calling thread's batch), which is not evicted while any handle to it
+// exists.
+class fhicl::ParameterSetRegistry::handle {
+public:
+  handle() noexcept = default;
+  handle(handle const& other) noexcept;
+  handle(handle&& other) noexcept;
+  handle& operator=(handle other) noexcept;
+  ~handle();
+
+  explicit operator bool() const noexcept;
+  ParameterSet const& operator*() const noexcept;
+  ParameterSet const* operator->() const noexcept;
+  ParameterSetID const& id() const noexcept;
+  // Keeps the entry from being evicted without referring to it.
+  detail::registry_pin pin() const noexcept;
+
+private:
+  friend class ParameterSetRegistry;
+  handle(value_type const* entry, usage* u) noexcept;
+
+  value_type const* entry_{nullptr};
+  usage* usage_{nullptr};
+};
+
+// An anchor is a handle that also keeps the entry, together with the
+// tables it refers to, from being collected as garbage.  Unlike a root,
+// it does not make garbage collection take place.  Taking or copying
+// an anchor briefly locks the backing DB.
+class fhicl::ParameterSetRegistry::anchor {
+public:
+  anchor() noexcept = default;
+  explicit anchor(ParameterSetID const& id);
+  anchor(anchor const& other);
+  anchor(anchor&& other) noexcept = default;
+  anchor& operator=(anchor other) noexcept;
+  ~anchor();
+
+  explicit operator bool() const noexcept;
+  ParameterSet const& operator*() const noexcept;
+  ParameterSet const* operator->() const noexcept;
+
+private:
+  void hold_();
+
+  handle handle_;
+};
+
+// While a pin_scope object exists, the entries whose references are
+// returned by 'get' on the thread that created it are pinned until it
+// is destroyed, rather than for the lifetime of the registry.  Scopes
+// may be nested.
+class fhicl::ParameterSetRegistry::pin_scope {
+public:
+  pin_scope() noexcept;
+  ~pin_scope();
+
+  pin_scope(pin_scope const&) = delete;
+  pin_scope& operator=(pin_scope const&) = delete;
+
+private:
+  friend class ParameterSetRegistry;
+  pin_scope* previous_;
+  std::vector<handle> pins_;
+};
+
+// A snapshot holds the entries registered before it was taken, in
+// order of registration, so nested tables precede the tables that
+// contain them.  Entries buffered by an unpublished batch are not
+// included.  Taking a snapshot copies only pointers to the entries,
+// holding each shard's lock briefly; the snapshot itself is immutable
+// and may be iterated without locking while entries are being put.
+// The entries are not evicted while the snapshot exists.
+class fhicl::ParameterSetRegistry::snapshot {
+public:
+  using const_iterator = boost::indirect_iterator<
+    std::vector<value_type const*>::const_iterator>;
+
+  bool empty() const noexcept;
+  size_type size() const noexcept;
+  const_iterator begin() const noexcept;
+  const_iterator end() const noexcept;
+
+private:
+  friend class ParameterSetRegistry;
+  snapshot(std::vector<value_type const*> entries,
+           std::vector<handle> pins) noexcept;
+
+  std::vector<value_type const*> entries_;
+  std::vector<handle> pins_;
+};
+
+// The statistics are gathered only if the library is built with
+// FHICLCPP_REGISTRY_STATS defined; otherwise, 'enabled' is false and
+// all counts are zero.  Times are in nanoseconds.  Bucket i of a
+// histogram counts the latencies in [2^i, 2^(i+1)) ns; bucket 0 also
+// counts those shorter, and the last one those longer.
+struct fhicl::ParameterSetRegistry::statistics {
+  struct latency {
+    std::uint64_t count;
+    std::uint64_t nanoseconds;
+    std::array<std::uint64_t, 40> histogram;
+  };
+  struct operation {
+    std::uint64_t calls;
+    std::uint64_t rows;
+    std::uint64_t nanoseconds;
+  };
+
+  bool enabled;
+  std::uint64_t new_puts;
+  std::uint64_t duplicate_puts;
+  std::uint64_t lookups;
+  // Look-ups of entries not registered, which fall through to the
+  // mapped files and the backing DB.
+  latency db_lookups;
+  // Waits for the lock on the backing DB.
+  latency lock_waits;
+  operation stage_in;
+  operation import_from;  // Rows added to the backing DB.
+  operation export_to;    // Rows written to the target DB.
+};
+
+// ----------------------------------------------------------------------
 
 // 1.
-inline auto
+inline fhicl::ParameterSetID
 fhicl::ParameterSetRegistry::put(ParameterSet const& ps)
-  -> ParameterSetID const&
 {
-  std::lock_guard sentry{mutex_};
-  return instance_().registry_.emplace(ps.id(), ps).first->first;
+  // Compute the ID before locking so that concurrent insertions
+  // are not serialized on hashing.
+  auto const id = ps.id();
+  if (pending_()) {
+    buffer_(id, ps);
+    return id;
+  }
+  insert_(id, ps);
+  if (over_capacity_()) {
+    evict_();
+  }
+  return id;
 }
 
 // 2.
@@ -129,7 +528,7 @@ inline auto
 fhicl::ParameterSetRegistry::put(FwdIt b, FwdIt const e) -> std::enable_if_t<
   std::is_same_v<typename std::iterator_traits<FwdIt>::value_type, mapped_type>>
 {
-  // No lock here -- it will be acquired by 3.
+  // No lock here -- it will be acquired by 1.
   for (; b != e; ++b) {
     (void)put(*b);
   }
@@ -143,8 +542,13 @@ fhicl::ParameterSetRegistry::put(FwdIt const b, FwdIt const e)
     std::is_same_v<typename std::iterator_traits<FwdIt>::value_type,
                    value_type>>
 {
-  std::lock_guard sentry{mutex_};
-  instance_().registry_.insert(b, e);
+  // No lock here -- it will be acquired by insert_.
+  for (auto it = b; it != e; ++it) {
+    insert_(it->first, it->second);
+  }
+  if (over_capacity_()) {
+    evict_();
+  }
 }
 
 // 4.
@@ -156,44 +560,61 @@ fhicl::ParameterSetRegistry::put(collection_type const& c)
 }
 
 inline auto
-fhicl::ParameterSetRegistry::get() noexcept -> collection_type const&
+fhicl::ParameterSetRegistry::acquire(ParameterSetID const& id) -> handle
 {
-  std::lock_guard sentry{mutex_};
-  return instance_().registry_;
+  if (auto pending = pending_()) {
+    if (auto it = pending->find(id); it != pending->cend()) {
+      // Another thread may have registered it since it was buffered.
+      if (auto registered = instance_().find_registered_(id)) {
+        return registered;
+      }
+      return handle{&*it, pending_usage_(id)};
+    }
+  }
+  auto result = instance_().find_(id);
+  if (!result) {
+    throw exception(error::cant_find, "Can't find ParameterSet")
+      << "with ID " << id.to_string() << " in the registry.";
+  }
+  return result;
 }
 
 inline auto
 fhicl::ParameterSetRegistry::get(ParameterSetID const& id)
   -> ParameterSet const&
 {
-  std::lock_guard sentry{mutex_};
-  auto it = instance_().find_(id);
-  if (it == instance_().registry_.cend()) {
-    throw exception(error::cant_find, "Can't find ParameterSet")
-      << "with ID " << id.to_string() << " in the registry.";
+  auto const h = acquire(id);
+  if (h.usage_ != nullptr) {
+    retain_(h);
   }
-  return it->second;
+  return *h;
 }
 
 inline bool
 fhicl::ParameterSetRegistry::get(ParameterSetID const& id, ParameterSet& ps)
 {
-  std::lock_guard sentry{mutex_};
-  bool result{false};
-  auto it = instance_().find_(id);
-  if (it != instance_().registry_.cend()) {
-    ps = it->second;
-    result = true;
+  if (auto pending = pending_()) {
+    if (auto it = pending->find(id); it != pending->cend()) {
+      ps = it->second;
+      return true;
+    }
   }
-  return result;
+  if (auto const found = instance_().find_(id)) {
+    ps = *found;
+    return true;
+  }
+  return false;
 }
 
 inline bool
 fhicl::ParameterSetRegistry::has(ParameterSetID const& id)
 {
-  std::lock_guard sentry{mutex_};
-  auto const& reg = instance_().registry_;
-  return reg.find(id) != reg.cend();
+  if (auto pending = pending_(); pending && pending->count(id) != 0) {
+    return true;
+  }
+  auto const& s = shard_for_(id);
+  std::shared_lock sentry{s.mutex};
+  return s.entries.find(id) != s.entries.cend();
 }
 
 inline auto
@@ -203,10 +624,135 @@ fhicl::ParameterSetRegistry::instance_() -> ParameterSetRegistry&
   return s_registry;
 }
 
+inline bool
+fhicl::ParameterSetRegistry::over_capacity_() noexcept
+{
+  auto const& registry = instance_();
+  auto const capacity = registry.capacity_.load(std::memory_order_relaxed);
+  return capacity != 0 &&
+         registry.size_.load(std::memory_order_relaxed) > capacity;
+}
+
+inline std::size_t
+fhicl::ParameterSetRegistry::shard_index_(ParameterSetID const& id) noexcept
+{
+  // The last byte of the digest selects the shard; the leading bytes
+  // are used for hashing within the shard.
+  return id.digest().back() % n_shards;
+}
+
+inline auto
+fhicl::ParameterSetRegistry::shard_for_(ParameterSetID const& id) noexcept
+  -> shard&
+{
+  return instance_().shards_[shard_index_(id)];
+}
+
+// ----------------------------------------------------------------------
+
+inline fhicl::ParameterSetRegistry::handle::handle(value_type const* entry,
+                                                   usage* const u) noexcept
+  : entry_{entry}, usage_{u}
+{
+  if (usage_ != nullptr) {
+    ++usage_->pins;
+  }
+}
+
+inline fhicl::ParameterSetRegistry::handle::handle(
+  handle const& other) noexcept
+  : handle{other.entry_, other.usage_}
+{}
+
+inline fhicl::ParameterSetRegistry::handle::handle(handle&& other) noexcept
+  : entry_{std::exchange(other.entry_, nullptr)}
+  , usage_{std::exchange(other.usage_, nullptr)}
+{}
+
+inline auto
+fhicl::ParameterSetRegistry::handle::operator=(handle other) noexcept
+  -> handle&
+{
+  std::swap(entry_, other.entry_);
+  std::swap(usage_, other.usage_);
+  return *this;
+}
+
+inline fhicl::ParameterSetRegistry::handle::~handle()
+{
+  if (usage_ != nullptr) {
+    --usage_->pins;
+  }
+}
+
+inline fhicl::ParameterSetRegistry::handle::operator bool() const noexcept
+{
+  return entry_ != nullptr;
+}
+
+inline auto
+fhicl::ParameterSetRegistry::handle::operator*() const noexcept
+  -> ParameterSet const&
+{
+  return entry_->second;
+}
+
+inline auto
+fhicl::ParameterSetRegistry::handle::operator->() const noexcept
+  -> ParameterSet const*
+{
+  return &entry_->second;
+}
+
+inline auto
+fhicl::ParameterSetRegistry::handle::id() const noexcept
+  -> ParameterSetID const&
+{
+  return entry_->first;
+}
+
+inline auto
+fhicl::ParameterSetRegistry::handle::pin() const noexcept
+  -> detail::registry_pin
+{
+  return detail::registry_pin{usage_ != nullptr ? &usage_->pins : nullptr};
+}
+
+inline auto
+fhicl::ParameterSetRegistry::anchor::operator=(anchor other) noexcept
+  -> anchor&
+{
+  std::swap(handle_, other.handle_);
+  return *this;
+}
+
+inline fhicl::ParameterSetRegistry::anchor::operator bool() const noexcept
+{
+  return static_cast<bool>(handle_);
+}
+
+inline auto
+fhicl::ParameterSetRegistry::anchor::operator*() const noexcept
+  -> ParameterSet const&
+{
+  return *handle_;
+}
+
+inline auto
+fhicl::ParameterSetRegistry::anchor::operator->() const noexcept
+  -> ParameterSet const*
+{
+  return handle_.operator->();
+}
+
 inline size_t
-fhicl::detail::HashParameterSetID::operator()(ParameterSetID const& id) const
+fhicl::detail::HashParameterSetID::operator()(
+  ParameterSetID const& id) const noexcept
 {
-  return hash_(id.to_string());
+  size_t result;
+  static_assert(sizeof(result) <= std::tuple_size_v<cet::sha1::digest_t>);
+  std::memcpy(&result, id.digest().data(), sizeof(result));
+  return result;
 }
 
 #endif /* fhiclcpp_ParameterSetRegistry_h */
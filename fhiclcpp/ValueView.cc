@@ -0,0 +1,157 @@
+// ======================================================================
+//
+// ValueView
+//
+// ======================================================================
+
+#include "fhiclcpp/ValueView.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/ParameterSetRegistry.h"
+
+using namespace fhicl;
+using namespace fhicl::detail;
+
+using std::any;
+using std::any_cast;
+
+// ======================================================================
+
+ValueView::ValueView(ParameterSet const& table) noexcept
+  : kind_{value_kind::table}, table_{&table}
+{}
+
+ValueView::ValueView(any const& value,
+                     ParameterSet const& owner,
+                     registry_pin owner_pin)
+  : value_{&value}, owner_{&owner}, owner_pin_{std::move(owner_pin)}
+{
+  if (detail::is_table(value)) {
+    kind_ = value_kind::table;
+    auto const table =
+      ParameterSetRegistry::acquire(any_cast<ParameterSetID const&>(value));
+    table_ = &*table;
+    table_pin_ = table.pin();
+  } else if (detail::is_sequence(value)) {
+    kind_ = value_kind::sequence;
+  } else if (detail::is_nil(value)) {
+    kind_ = value_kind::nil;
+  } else {
+    kind_ = value_kind::atom;
+  }
+}
+
+// ----------------------------------------------------------------------
+
+std::size_t
+ValueView::size() const
+{
+  switch (kind_) {
+  case value_kind::sequence:
+    return any_cast<ps_sequence_t const&>(*value_).size();
+  case value_kind::table:
+    return table_->mapping_.size();
+  default:
+    return 0ull;
+  }
+}
+
+ValueView
+ValueView::operator[](std::size_t const index) const
+{
+  if (kind_ != value_kind::sequence) {
+    return {};
+  }
+  auto const& seq = any_cast<ps_sequence_t const&>(*value_);
+  return index < seq.size() ? ValueView{seq[index], *owner_, owner_pin_} :
+                              ValueView{};
+}
+
+ValueView
+ValueView::operator[](std::string const& key) const
+{
+  return kind_ == value_kind::table ? table_->lookup_(key, table_pin_) :
+                                      ValueView{};
+}
+
+auto
+ValueView::begin() const -> const_iterator
+{
+  switch (kind_) {
+  case value_kind::sequence:
+    return const_iterator{any_cast<ps_sequence_t const&>(*value_).cbegin(),
+                          owner_,
+                          owner_pin_};
+  case value_kind::table:
+    return const_iterator{table_->mapping_.cbegin(), table_, table_pin_};
+  default:
+    return const_iterator{};
+  }
+}
+
+auto
+ValueView::end() const -> const_iterator
+{
+  switch (kind_) {
+  case value_kind::sequence:
+    return const_iterator{any_cast<ps_sequence_t const&>(*value_).cend(),
+                          owner_,
+                          owner_pin_};
+  case value_kind::table:
+    return const_iterator{table_->mapping_.cend(), table_, table_pin_};
+  default:
+    return const_iterator{};
+  }
+}
+
+member_range
+ValueView::members() const
+{
+  return kind_ == value_kind::table ?
+           table_->members_(member_filter::all, table_pin_) :
+           member_range{};
+}
+
+std::string_view
+ValueView::as_view() const
+{
+  if (kind_ == value_kind::absent) {
+    throw exception(cant_find, "Attempt to view an absent value.");
+  }
+  if (value_ == nullptr) {
+    throw_not_convertible_("std::string_view");
+  }
+  auto const view = atom_view(*value_);
+  if (!needs_unescaping(any_cast<ps_atom_t const&>(*value_))) {
+    return view;
+  }
+  return owner_->unescaped_.get(*value_, view);
+}
+
+ParameterSet const&
+ValueView::table() const
+{
+  if (kind_ != value_kind::table) {
+    throw exception(type_mismatch, "ValueView does not refer to a table.");
+  }
+  return *table_;
+}
+
+std::string
+ValueView::to_string() const
+{
+  if (kind_ == value_kind::absent) {
+    return {};
+  }
+  if (value_ == nullptr) {
+    return '{' + table_->to_string() + '}';
+  }
+  return owner_->stringify_(*value_);
+}
+
+void
+ValueView::throw_not_convertible_(std::string const& type) const
+{
+  throw exception(type_mismatch)
+    << "\nUnsuccessful attempt to convert a top-level ParameterSet to type '"
+    << type << "'.\n";
+}
@@ -0,0 +1,506 @@
+#ifndef fhiclcpp_ValueView_h
+#define fhiclcpp_ValueView_h
+
+// ======================================================================
+//
+// ValueView: Non-owning view of a single value stored in a
+//            ParameterSet.
+//
+// A ValueView is obtained via 'ParameterSet::lookup(key)', which
+// descends the key exactly once.  The view knows what kind of value
+// it refers to, and it provides access to that value's children
+// (sequence elements or table members) without copying the
+// underlying data:
+//
+//   auto const v = pset.lookup("physics.producers");
+//   if (v.is_table()) {
+//     for (auto const& member : v) {
+//       ...
+//     }
+//   }
+//   auto const n = pset.lookup("seq")[2].as<int>();
+//   std::string_view const file = pset.lookup("files")[0].as_view();
+//
+// The members of a table, together with their keys, are visited via a
+// member_range, as returned by 'ParameterSet::members()' (or one of
+// its filtered variants) or 'ValueView::members()':
+//
+//   for (auto const& [key, value] : pset.table_members()) {
+//     ...
+//   }
+//
+// Neither the keys nor the values are copied.
+//
+// A ValueView refers to data owned by a ParameterSet (or by the
+// ParameterSetRegistry in the case of nested tables).  It must not
+// outlive the ParameterSet from which it was obtained, nor be used
+// after that ParameterSet is modified.  The nested tables it refers
+// to are not evicted from the registry while the view, or an iterator
+// or member_range obtained from it, exists.
+//
+// ======================================================================
+
+#include "cetlib_except/demangle.h"
+#include "fhiclcpp/coding.h"
+#include "fhiclcpp/detail/registry_pin.h"
+#include "fhiclcpp/exception.h"
+#include "fhiclcpp/fwd.h"
+#include "fhiclcpp/get_result.h"
+
+#include <any>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+namespace fhicl {
+  enum class value_kind { absent, nil, atom, sequence, table };
+
+  class member_iterator;
+  class member_range;
+
+  namespace detail {
+    // Nil values are regarded as atoms, as in
+    // 'ParameterSet::is_key_to_atom'.
+    enum class member_filter { all, tables, sequences, atoms };
+  }
+}
+
+class fhicl::ValueView {
+public:
+  class const_iterator;
+
+  // An absent value.
+  ValueView() = default;
+  // The table corresponding to an entire ParameterSet.
+  explicit ValueView(ParameterSet const& table) noexcept;
+
+  // observers:
+  value_kind kind() const noexcept;
+  explicit operator bool() const noexcept;
+  bool exists() const noexcept;
+  bool is_nil() const noexcept;
+  bool is_atom() const noexcept;
+  bool is_sequence() const noexcept;
+  bool is_table() const noexcept;
+
+  // Number of sequence elements or table members; zero otherwise.
+  std::size_t size() const;
+  bool empty() const;
+
+  // children (absent if not present):
+  ValueView operator[](std::size_t index) const;
+  ValueView operator[](std::string const& key) const; // nested key OK
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  // (key, value) pairs of a table; empty otherwise.
+  member_range members() const;
+
+  // retrievers:
+  template <class T>
+  T as() const;
+  // As above, but failures are reported via the result; no exception
+  // is thrown.
+  template <class T>
+  get_result<T> try_as() const;
+  // String value without copying; valid as long as the owning
+  // ParameterSet is neither modified nor destroyed.
+  std::string_view as_view() const;
+  ParameterSet const& table() const;
+  // FHiCL representation of the value, as in 'ParameterSet::to_string';
+  // empty for an absent value.
+  std::string to_string() const;
+
+private:
+  friend class ParameterSet;
+  friend class member_iterator;
+  ValueView(std::any const& value,
+            ParameterSet const& owner,
+            detail::registry_pin owner_pin = {});
+
+  using member_iter_t = std::map<std::string, std::any>::const_iterator;
+  using element_iter_t = detail::ps_sequence_t::const_iterator;
+
+  [[noreturn]] void throw_not_convertible_(std::string const& type) const;
+
+  value_kind kind_{value_kind::absent};
+  std::any const* value_{nullptr};
+  ParameterSet const* owner_{nullptr};
+  ParameterSet const* table_{nullptr};
+  detail::registry_pin owner_pin_{};
+  detail::registry_pin table_pin_{};
+}; // ValueView
+
+// ----------------------------------------------------------------------
+
+// Iterates over the elements of a sequence or the members of a table
+// (in canonical key order).  Iterating over an atom, nil, or absent
+// value yields an empty range.
+class fhicl::ValueView::const_iterator {
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = ValueView;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = ValueView;
+
+  const_iterator() = default;
+
+  ValueView operator*() const;
+  const_iterator& operator++();
+  const_iterator operator++(int);
+
+  bool operator==(const_iterator const& other) const noexcept;
+  bool operator!=(const_iterator const& other) const noexcept;
+
+private:
+  friend class ValueView;
+  const_iterator(element_iter_t it,
+                 ParameterSet const* owner,
+                 detail::registry_pin owner_pin) noexcept;
+  const_iterator(member_iter_t it,
+                 ParameterSet const* owner,
+                 detail::registry_pin owner_pin) noexcept;
+
+  ParameterSet const* owner_{nullptr};
+  detail::registry_pin owner_pin_{};
+  bool is_member_iter_{false};
+  element_iter_t element_{};
+  member_iter_t member_{};
+};
+
+// ----------------------------------------------------------------------
+
+// Iterates over the members of a table in canonical key order,
+// yielding (key, value) pairs.  Members not selected by the filter
+// are skipped.
+class fhicl::member_iterator {
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = std::pair<std::string_view, ValueView>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = value_type;
+
+  member_iterator() = default;
+
+  value_type operator*() const;
+  member_iterator& operator++();
+  member_iterator operator++(int);
+
+  bool operator==(member_iterator const& other) const noexcept;
+  bool operator!=(member_iterator const& other) const noexcept;
+
+private:
+  friend class ParameterSet;
+  friend class ValueView;
+  using iter_t = std::map<std::string, std::any>::const_iterator;
+
+  member_iterator(iter_t it,
+                  iter_t end,
+                  ParameterSet const* owner,
+                  detail::member_filter filter,
+                  detail::registry_pin owner_pin = {}) noexcept;
+
+  bool selected_() const noexcept;
+  void skip_() noexcept;
+
+  iter_t it_{};
+  iter_t end_{};
+  ParameterSet const* owner_{nullptr};
+  detail::member_filter filter_{detail::member_filter::all};
+  detail::registry_pin owner_pin_{};
+};
+
+class fhicl::member_range {
+public:
+  member_range() = default;
+  member_range(member_iterator b, member_iterator e) noexcept
+    : begin_{b}, end_{e}
+  {}
+
+  member_iterator
+  begin() const noexcept
+  {
+    return begin_;
+  }
+  member_iterator
+  end() const noexcept
+  {
+    return end_;
+  }
+  bool
+  empty() const noexcept
+  {
+    return begin_ == end_;
+  }
+
+private:
+  member_iterator begin_{};
+  member_iterator end_{};
+};
+
+// ======================================================================
+
+inline fhicl::value_kind
+fhicl::ValueView::kind() const noexcept
+{
+  return kind_;
+}
+
+inline fhicl::ValueView::operator bool() const noexcept
+{
+  return exists();
+}
+
+inline bool
+fhicl::ValueView::exists() const noexcept
+{
+  return kind_ != value_kind::absent;
+}
+
+inline bool
+fhicl::ValueView::is_nil() const noexcept
+{
+  return kind_ == value_kind::nil;
+}
+
+inline bool
+fhicl::ValueView::is_atom() const noexcept
+{
+  return kind_ == value_kind::atom;
+}
+
+inline bool
+fhicl::ValueView::is_sequence() const noexcept
+{
+  return kind_ == value_kind::sequence;
+}
+
+inline bool
+fhicl::ValueView::is_table() const noexcept
+{
+  return kind_ == value_kind::table;
+}
+
+inline bool
+fhicl::ValueView::empty() const
+{
+  return size() == 0ull;
+}
+
+template <class T>
+T
+fhicl::ValueView::as() const
+{
+  if (kind_ == value_kind::absent) {
+    throw fhicl::exception(cant_find, "Attempt to convert an absent value.");
+  }
+  if constexpr (std::is_same_v<T, ParameterSet>) {
+    if (kind_ == value_kind::table) {
+      return T{*table_};
+    }
+  }
+  if (value_ == nullptr) {
+    // A view of an entire ParameterSet can only be converted to a
+    // ParameterSet.
+    throw_not_convertible_(cet::demangle_symbol(typeid(T).name()));
+  }
+
+  T value;
+  try {
+    using detail::decode;
+    decode(*value_, value);
+  }
+  catch (fhicl::exception const& e) {
+    std::ostringstream errmsg;
+    errmsg << "\nUnsuccessful attempt to convert FHiCL value to type '"
+           << cet::demangle_symbol(typeid(value).name()) << "'.\n\n"
+           << "[Specific error:]";
+    throw fhicl::exception(type_mismatch, errmsg.str(), e);
+  }
+  catch (std::exception const& e) {
+    std::ostringstream errmsg;
+    errmsg << "\nUnsuccessful attempt to convert FHiCL value to type '"
+           << cet::demangle_symbol(typeid(value).name()) << "'.\n\n"
+           << "[Specific error:]\n"
+           << e.what() << "\n\n";
+    throw fhicl::exception(type_mismatch, errmsg.str());
+  }
+  return value;
+}
+
+template <class T>
+fhicl::get_result<T>
+fhicl::ValueView::try_as() const
+{
+  if (kind_ == value_kind::absent) {
+    return get_error::missing;
+  }
+  if constexpr (std::is_same_v<T, ParameterSet>) {
+    if (kind_ == value_kind::table) {
+      return T{*table_};
+    }
+  }
+  if (value_ == nullptr) {
+    return get_error::type_mismatch;
+  }
+
+  T value{};
+  using detail::try_decode;
+  if (auto const status = try_decode(*value_, value)) {
+    return *status;
+  }
+  return value;
+}
+
+// ----------------------------------------------------------------------
+
+inline fhicl::ValueView::const_iterator::const_iterator(
+  element_iter_t const it,
+  ParameterSet const* owner,
+  detail::registry_pin owner_pin) noexcept
+  : owner_{owner}, owner_pin_{std::move(owner_pin)}, element_{it}
+{}
+
+inline fhicl::ValueView::const_iterator::const_iterator(
+  member_iter_t const it,
+  ParameterSet const* owner,
+  detail::registry_pin owner_pin) noexcept
+  : owner_{owner}
+  , owner_pin_{std::move(owner_pin)}
+  , is_member_iter_{true}
+  , member_{it}
+{}
+
+inline fhicl::ValueView
+fhicl::ValueView::const_iterator::operator*() const
+{
+  return is_member_iter_ ? ValueView{member_->second, *owner_, owner_pin_} :
+                           ValueView{*element_, *owner_, owner_pin_};
+}
+
+inline auto
+fhicl::ValueView::const_iterator::operator++() -> const_iterator&
+{
+  if (is_member_iter_) {
+    ++member_;
+  } else {
+    ++element_;
+  }
+  return *this;
+}
+
+inline auto
+fhicl::ValueView::const_iterator::operator++(int) -> const_iterator
+{
+  auto tmp = *this;
+  ++*this;
+  return tmp;
+}
+
+inline bool
+fhicl::ValueView::const_iterator::operator==(
+  const_iterator const& other) const noexcept
+{
+  return is_member_iter_ == other.is_member_iter_ &&
+         (is_member_iter_ ? member_ == other.member_ :
+                            element_ == other.element_);
+}
+
+inline bool
+fhicl::ValueView::const_iterator::operator!=(
+  const_iterator const& other) const noexcept
+{
+  return !operator==(other);
+}
+
+// ----------------------------------------------------------------------
+
+inline fhicl::member_iterator::member_iterator(
+  iter_t const it,
+  iter_t const end,
+  ParameterSet const* owner,
+  detail::member_filter const filter,
+  detail::registry_pin owner_pin) noexcept
+  : it_{it}
+  , end_{end}
+  , owner_{owner}
+  , filter_{filter}
+  , owner_pin_{std::move(owner_pin)}
+{
+  skip_();
+}
+
+inline bool
+fhicl::member_iterator::selected_() const noexcept
+{
+  auto const& value = it_->second;
+  switch (filter_) {
+  case detail::member_filter::tables:
+    return detail::is_table(value);
+  case detail::member_filter::sequences:
+    return detail::is_sequence(value);
+  case detail::member_filter::atoms:
+    return !detail::is_table(value) && !detail::is_sequence(value);
+  default:
+    return true;
+  }
+}
+
+inline void
+fhicl::member_iterator::skip_() noexcept
+{
+  while (it_ != end_ && !selected_()) {
+    ++it_;
+  }
+}
+
+inline auto
+fhicl::member_iterator::operator*() const -> value_type
+{
+  return {it_->first, ValueView{it_->second, *owner_, owner_pin_}};
+}
+
+inline auto
+fhicl::member_iterator::operator++() -> member_iterator&
+{
+  ++it_;
+  skip_();
+  return *this;
+}
+
+inline auto
+fhicl::member_iterator::operator++(int) -> member_iterator
+{
+  auto tmp = *this;
+  ++*this;
+  return tmp;
+}
+
+inline bool
+fhicl::member_iterator::operator==(member_iterator const& other) const noexcept
+{
+  return it_ == other.it_;
+}
+
+inline bool
+fhicl::member_iterator::operator!=(member_iterator const& other) const noexcept
+{
+  return !operator==(other);
+}
+
+// ======================================================================
+
+#endif /* fhiclcpp_ValueView_h */
+
+// Local Variables:
+// mode: c++
+// End:
@@ -11,10 +11,13 @@
 #include "fhiclcpp/ParameterSet.h"
 #include "fhiclcpp/ParameterSetRegistry.h"
 
+#include <cmath>
 #include <cstddef>
 #include <cstdlib>
 #include <limits>
+#include <optional>
 #include <stdexcept>
+#include <string_view>
 
 using namespace fhicl;
 using namespace fhicl::detail;
@@ -26,43 +29,52 @@ using std::any_cast;
 
 // ======================================================================
 
-static inline std::string
+// The canonical representations below are returned by reference so
+// that comparisons against them do not allocate.
+
+static inline std::string const&
 canon_nil()
 {
   static std::string const canon_nil(9, '\0');
   return canon_nil;
 }
 
-static inline ps_atom_t
+static inline ps_atom_t const&
 literal_true()
 {
-  static std::string literal_true("true");
+  static std::string const literal_true("true");
   return literal_true;
 }
 
-static inline ps_atom_t
+static inline ps_atom_t const&
 literal_false()
 {
-  static std::string literal_false("false");
+  static std::string const literal_false("false");
   return literal_false;
 }
 
-static inline ps_atom_t
+static inline ps_atom_t const&
 literal_infinity()
 {
-  static std::string literal_infinity("infinity");
+  static std::string const literal_infinity("infinity");
   return literal_infinity;
 }
 
-static void
-atom_rep(any const& a, std::string& result)
+static inline bool
+is_double_quoted(std::string_view const str) noexcept
+{
+  return str.size() >= 2 && str.front() == '\"' && str.back() == '\"';
+}
+
+static std::string const&
+atom_rep(any const& a)
 {
   if (is_table(a))
     throw fhicl::exception(type_mismatch, "can't obtain atom from table");
   if (is_sequence(a))
     throw fhicl::exception(type_mismatch, "can't obtain atom from sequence");
 
-  result = any_cast<std::string>(a);
+  return any_cast<std::string const&>(a);
 }
 
 // ----------------------------------------------------------------------
@@ -70,12 +82,28 @@ atom_rep(any const& a, std::string& result)
 bool
 fhicl::detail::is_nil(std::any const& val)
 {
-  bool result = false;
-  if (!(is_table(val) || is_sequence(val))) {
-    std::string str;
-    atom_rep(val, str);
-    result = (str == canon_nil());
+  if (is_table(val) || is_sequence(val)) {
+    return false;
   }
+  return atom_rep(val) == canon_nil();
+}
+
+bool
+fhicl::detail::needs_unescaping(std::string_view const atom) noexcept
+{
+  return is_double_quoted(atom) &&
+         atom.find('\\') != std::string_view::npos;
+}
+
+std::string_view // string without delimiting quotes
+fhicl::detail::atom_view(any const& a)
+{
+  std::string_view result{atom_rep(a)};
+  if (result == canon_nil())
+    throw fhicl::exception(type_mismatch, "can't obtain string from nil");
+
+  if (is_double_quoted(result))
+    result = result.substr(1, result.size() - 2);
   return result;
 }
 
@@ -164,19 +192,19 @@ fhicl::detail::encode(ldbl value)
 void // string without delimiting quotes
 fhicl::detail::decode(any const& a, std::string& result)
 {
-  atom_rep(a, result);
-  if (result == canon_nil())
-    throw fhicl::exception(type_mismatch, "can't obtain string from nil");
-
-  if (result.size() >= 2 && result[0] == '\"' && result.end()[-1] == '\"')
-    result = cet::unescape(result.substr(1, result.size() - 2));
+  auto const& atom = atom_rep(a);
+  if (needs_unescaping(atom)) {
+    result = cet::unescape(atom.substr(1, atom.size() - 2));
+    return;
+  }
+  auto const view = atom_view(a);
+  result.assign(view.data(), view.size());
 }
 
 void // nil
 fhicl::detail::decode(any const& a, std::nullptr_t& result)
 {
-  std::string str;
-  atom_rep(a, str);
+  auto const& str = atom_rep(a);
 
   if (str != canon_nil())
     throw fhicl::exception(type_mismatch, "error in nil string:\n") << str;
@@ -205,7 +233,7 @@ void // table
 fhicl::detail::decode(any const& a, ParameterSet& result)
 {
   auto const id = any_cast<ParameterSetID>(a);
-  result = ParameterSetRegistry::get(id);
+  result = *ParameterSetRegistry::acquire(id);
 }
 
 void // unsigned
@@ -262,7 +290,7 @@ fhicl::detail::decode(any const& a, ldbl& result)
       << unparsed;
 
   auto const& atom = extended_value::atom_t(xval);
-  if (atom.substr(1) == literal_infinity()) {
+  if (std::string_view{atom}.substr(1) == literal_infinity()) {
     switch (atom[0]) {
     case '+':
       result = +std::numeric_limits<ldbl>::infinity();
@@ -296,3 +324,216 @@ fhicl::detail::decode(any const& a, std::complex<ldbl>& result)
 }
 
 // ======================================================================
+
+// ======================================================================
+// Exception-free decoding
+
+static bool
+is_non_nil_atom(any const& a)
+{
+  return a.type() == typeid(ps_atom_t) &&
+         any_cast<ps_atom_t const&>(a) != canon_nil();
+}
+
+// The text 'decode(a, std::string&)' would produce; 'buffer' is used
+// only if the atom must be unescaped.
+static std::optional<std::string_view>
+atom_text(any const& a, std::string& buffer)
+{
+  if (!is_non_nil_atom(a)) {
+    return std::nullopt;
+  }
+  auto const& atom = any_cast<ps_atom_t const&>(a);
+  if (needs_unescaping(atom)) {
+    buffer = cet::unescape(atom.substr(1, atom.size() - 2));
+    return buffer;
+  }
+  return atom_view(a);
+}
+
+// Accepts the forms of the FHiCL 'uint', 'real' and 'inf' number
+// tokens; hexadecimal and binary numbers are not convertible by
+// 'decode' either.
+decode_status
+fhicl::detail::try_decode_number(std::string_view const str, ldbl& result)
+{
+  bool const has_sign = !str.empty() && (str[0] == '+' || str[0] == '-');
+  auto const unsigned_part = has_sign ? str.substr(1) : str;
+  if (unsigned_part == literal_infinity()) {
+    result = std::numeric_limits<ldbl>::infinity();
+    if (str[0] == '-') {
+      result = -result;
+    }
+    return std::nullopt;
+  }
+
+  auto const is_digit = [](char const c) { return c >= '0' && c <= '9'; };
+  auto it = unsigned_part.cbegin();
+  auto const e = unsigned_part.cend();
+  std::size_t n_digits{};
+  for (; it != e && is_digit(*it); ++it, ++n_digits)
+    ;
+  if (it != e && *it == '.') {
+    for (++it; it != e && is_digit(*it); ++it, ++n_digits)
+      ;
+  }
+  if (n_digits == 0) {
+    return get_error::type_mismatch;
+  }
+  if (it != e && (*it == 'e' || *it == 'E')) {
+    ++it;
+    if (it != e && (*it == '+' || *it == '-')) {
+      ++it;
+    }
+    if (it == e || !is_digit(*it)) {
+      return get_error::type_mismatch;
+    }
+    for (; it != e && is_digit(*it); ++it)
+      ;
+  }
+  if (it != e) {
+    return get_error::type_mismatch;
+  }
+
+  // strtold requires a null-terminated string.
+  char buffer[64];
+  if (str.size() < sizeof buffer) {
+    str.copy(buffer, str.size());
+    buffer[str.size()] = '\0';
+    result = std::strtold(buffer, nullptr);
+  } else {
+    result = std::strtold(std::string{str}.c_str(), nullptr);
+  }
+  return std::nullopt;
+}
+
+static decode_status
+decode_number_atom(any const& a, ldbl& result)
+{
+  std::string buffer;
+  auto const text = atom_text(a, buffer);
+  if (!text) {
+    return get_error::type_mismatch;
+  }
+  return try_decode_number(*text, result);
+}
+
+// Checks that 'value' is integral and lies within [lower, upper).
+static decode_status
+check_integral(ldbl const value, ldbl const lower, ldbl const upper)
+{
+  if (!(value >= lower && value < upper)) {
+    return get_error::out_of_range;
+  }
+  if (value != std::trunc(value)) {
+    return get_error::type_mismatch;
+  }
+  return std::nullopt;
+}
+
+bool
+fhicl::detail::is_sequence_string(any const& a)
+{
+  if (!is_non_nil_atom(a)) {
+    return false;
+  }
+  auto const text = atom_view(a);
+  auto const pos = text.find_first_not_of(" \t\n");
+  return pos != std::string_view::npos && text[pos] == '[';
+}
+
+decode_status // string without delimiting quotes
+fhicl::detail::try_decode(any const& a, std::string& result)
+{
+  if (!is_non_nil_atom(a)) {
+    return get_error::type_mismatch;
+  }
+  decode(a, result);
+  return std::nullopt;
+}
+
+decode_status // nil
+fhicl::detail::try_decode(any const& a, std::nullptr_t& result)
+{
+  if (a.type() != typeid(ps_atom_t) ||
+      any_cast<ps_atom_t const&>(a) != canon_nil()) {
+    return get_error::type_mismatch;
+  }
+  result = nullptr;
+  return std::nullopt;
+}
+
+decode_status // bool
+fhicl::detail::try_decode(any const& a, bool& result)
+{
+  std::string buffer;
+  auto const text = atom_text(a, buffer);
+  if (text == std::string_view{literal_true()}) {
+    result = true;
+  } else if (text == std::string_view{literal_false()}) {
+    result = false;
+  } else {
+    return get_error::type_mismatch;
+  }
+  return std::nullopt;
+}
+
+decode_status // table
+fhicl::detail::try_decode(any const& a, ParameterSet& result)
+{
+  if (!is_table(a)) {
+    return get_error::type_mismatch;
+  }
+  result = *ParameterSetRegistry::acquire(any_cast<ParameterSetID const&>(a));
+  return std::nullopt;
+}
+
+decode_status
+fhicl::detail::try_narrow(ldbl const value, std::uintmax_t& result)
+{
+  auto const limit =
+    std::ldexp(ldbl{1}, std::numeric_limits<std::uintmax_t>::digits);
+  if (auto const status = check_integral(value, 0, limit)) {
+    return status;
+  }
+  result = static_cast<std::uintmax_t>(value);
+  return std::nullopt;
+}
+
+decode_status
+fhicl::detail::try_narrow(ldbl const value, std::intmax_t& result)
+{
+  auto const limit =
+    std::ldexp(ldbl{1}, std::numeric_limits<std::intmax_t>::digits);
+  if (auto const status = check_integral(value, -limit, limit)) {
+    return status;
+  }
+  result = static_cast<std::intmax_t>(value);
+  return std::nullopt;
+}
+
+decode_status // unsigned
+fhicl::detail::try_decode(any const& a, std::uintmax_t& result)
+{
+  ldbl via{};
+  if (auto const status = decode_number_atom(a, via)) {
+    return status;
+  }
+  return try_narrow(via, result);
+}
+
+decode_status // signed
+fhicl::detail::try_decode(any const& a, std::intmax_t& result)
+{
+  ldbl via{};
+  if (auto const status = decode_number_atom(a, via)) {
+    return status;
+  }
+  return try_narrow(via, result);
+}
+
+decode_status // floating-point
+fhicl::detail::try_decode(any const& a, ldbl& result)
+{
+  return decode_number_atom(a, result);
+}
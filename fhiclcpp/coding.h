@@ -26,6 +26,7 @@
 #include "fhiclcpp/exception.h"
 #include "fhiclcpp/extended_value.h"
 #include "fhiclcpp/fwd.h"
+#include "fhiclcpp/get_result.h"
 #include "fhiclcpp/parse.h"
 #include "fhiclcpp/type_traits.h"
 
@@ -33,8 +34,12 @@
 #include <array>
 #include <complex>
 #include <cstdint>
+#include <limits>
+#include <optional>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -59,6 +64,13 @@ namespace fhicl::detail {
 
   bool is_nil(std::any const& val);
 
+  // Access to the stored representation of a string atom, without
+  // delimiting quotes and without copying.  If 'needs_unescaping'
+  // returns true for the stored atom, the view still contains escape
+  // sequences and must be passed through cet::unescape.
+  bool needs_unescaping(std::string_view atom) noexcept;
+  std::string_view atom_view(std::any const&);
+
   // ----------------------------------------------------------------------
 
   ps_atom_t encode(std::string const&);       // string (w/ quotes)
@@ -155,6 +167,84 @@ namespace fhicl::detail {
   tt::disable_if_t<tt::is_numeric<T>::value> decode(std::any const&,
                                                     T&); // none of the above
 
+  // ----------------------------------------------------------------------
+  // Exception-free counterparts of 'decode'; an empty status signals
+  // success.  Types for which no such conversion is provided (and
+  // sequences stored as string atoms) fall back to 'decode', with any
+  // exception mapped to the corresponding get_error.
+
+  using decode_status = std::optional<get_error>;
+
+  decode_status try_decode(std::any const&, std::string&);    // string
+  decode_status try_decode(std::any const&, std::nullptr_t&); // nil
+  decode_status try_decode(std::any const&, bool&);           // bool
+  decode_status try_decode(std::any const&, ParameterSet&);   // table
+  decode_status try_decode(std::any const&, std::uintmax_t&); // unsigned
+
+  template <class T>
+  std::enable_if_t<tt::is_uint<T>::value, decode_status> try_decode(
+    std::any const&,
+    T&); // unsigned
+
+  decode_status try_decode(std::any const&, std::intmax_t&); // signed
+
+  template <class T>
+  std::enable_if_t<tt::is_int<T>::value, decode_status> try_decode(
+    std::any const&,
+    T&); // signed
+
+  decode_status try_decode(std::any const&, ldbl&); // floating-point
+
+  template <class T>
+  std::enable_if_t<std::is_floating_point_v<T>, decode_status> try_decode(
+    std::any const&,
+    T&); // floating-point
+
+  template <class T>
+  decode_status try_decode(std::any const&, std::vector<T>&); // sequence
+
+  template <typename U>
+  decode_status try_decode_tuple(std::any const&, U& tuple);
+
+  template <typename T, std::size_t SIZE>
+  decode_status
+  try_decode(std::any const& a, std::array<T, SIZE>& result) // std::array
+  {
+    return try_decode_tuple(a, result);
+  }
+
+  template <typename KEY, typename VALUE>
+  decode_status
+  try_decode(std::any const& a, std::pair<KEY, VALUE>& result) // std::pair
+  {
+    return try_decode_tuple(a, result);
+  }
+
+  template <typename... ARGS>
+  decode_status
+  try_decode(std::any const& a, std::tuple<ARGS...>& result) // std::tuple
+  {
+    return try_decode_tuple(a, result);
+  }
+
+  template <class T>
+  tt::disable_if_t<tt::is_numeric<T>::value, decode_status> try_decode(
+    std::any const&,
+    T&); // none of the above
+
+  // Conversions of atom text (without delimiting quotes) to numbers,
+  // and of numbers to integers, as performed by 'try_decode'.
+  decode_status try_decode_number(std::string_view, ldbl&);
+  decode_status try_narrow(ldbl, std::uintmax_t&);
+  decode_status try_narrow(ldbl, std::intmax_t&);
+
+  // True if the value is an atom that may hold a sequence in string
+  // form (e.g. the value inserted via 'put(key, "[1, 2]")').
+  bool is_sequence_string(std::any const&);
+
+  template <class T>
+  decode_status decode_or_error(std::any const&, T&);
+
 } // fhicl::detail
 
 // ======================================================================
@@ -353,6 +443,146 @@ fhicl::detail::decode(std::any const& a, T& result)
   result = std::any_cast<T>(a);
 }
 
+// ======================================================================
+// Exception-free decoding
+
+template <class T>
+fhicl::detail::decode_status
+fhicl::detail::decode_or_error(std::any const& a, T& result)
+{
+  try {
+    decode(a, result);
+  }
+  catch (boost::numeric::bad_numeric_cast const&) {
+    return get_error::out_of_range;
+  }
+  catch (std::range_error const&) {
+    return get_error::out_of_range;
+  }
+  catch (std::exception const&) {
+    return get_error::type_mismatch;
+  }
+  return std::nullopt;
+}
+
+//===================================================================
+// unsigned
+template <class T>
+std::enable_if_t<tt::is_uint<T>::value, fhicl::detail::decode_status>
+fhicl::detail::try_decode(std::any const& a, T& result)
+{
+  std::uintmax_t via{};
+  if (auto const status = try_decode(a, via)) {
+    return status;
+  }
+  if (via > std::numeric_limits<T>::max()) {
+    return get_error::out_of_range;
+  }
+  result = static_cast<T>(via);
+  return std::nullopt;
+}
+
+//====================================================================
+// signed
+template <class T>
+std::enable_if_t<tt::is_int<T>::value, fhicl::detail::decode_status>
+fhicl::detail::try_decode(std::any const& a, T& result)
+{
+  std::intmax_t via{};
+  if (auto const status = try_decode(a, via)) {
+    return status;
+  }
+  if (via < std::numeric_limits<T>::min() ||
+      via > std::numeric_limits<T>::max()) {
+    return get_error::out_of_range;
+  }
+  result = static_cast<T>(via);
+  return std::nullopt;
+}
+
+//====================================================================
+// floating-point
+template <class T>
+std::enable_if_t<std::is_floating_point_v<T>, fhicl::detail::decode_status>
+fhicl::detail::try_decode(std::any const& a, T& result)
+{
+  ldbl via{};
+  if (auto const status = try_decode(a, via)) {
+    return status;
+  }
+  result = via;
+  return std::nullopt;
+}
+
+//====================================================================
+// sequence
+template <class T>
+fhicl::detail::decode_status
+fhicl::detail::try_decode(std::any const& a, std::vector<T>& result)
+{
+  if (!is_sequence(a)) {
+    return is_sequence_string(a) ? decode_or_error(a, result) :
+                                   get_error::type_mismatch;
+  }
+
+  auto const& seq = std::any_cast<ps_sequence_t const&>(a);
+  result.clear();
+  result.reserve(seq.size());
+  T via{};
+  for (auto const& e : seq) {
+    if (auto const status = try_decode(e, via)) {
+      return status;
+    }
+    result.push_back(via);
+  }
+  return std::nullopt;
+}
+
+//====================================================================
+// tuple-type support
+
+namespace fhicl::detail {
+  template <typename TUPLE, size_t... I>
+  decode_status
+  try_decode_tuple_entries(ps_sequence_t const& seq,
+                           TUPLE& result,
+                           std::index_sequence<I...>)
+  {
+    decode_status status;
+    ((status = try_decode(seq[I], std::get<I>(result)), !status) && ...);
+    return status;
+  }
+}
+
+template <typename U>
+fhicl::detail::decode_status
+fhicl::detail::try_decode_tuple(std::any const& a, U& result)
+{
+  constexpr std::size_t TUPLE_SIZE = std::tuple_size_v<U>;
+  if (!is_sequence(a)) {
+    return get_error::type_mismatch;
+  }
+  auto const& seq = std::any_cast<ps_sequence_t const&>(a);
+  if (seq.size() != TUPLE_SIZE) {
+    return get_error::type_mismatch;
+  }
+  return try_decode_tuple_entries(
+    seq, result, std::make_index_sequence<TUPLE_SIZE>());
+}
+
+//====================================================================
+template <class T> // none of the above
+tt::disable_if_t<tt::is_numeric<T>::value, fhicl::detail::decode_status>
+fhicl::detail::try_decode(std::any const& a, T& result)
+{
+  if (a.type() == typeid(T)) {
+    result = std::any_cast<T const&>(a);
+    return std::nullopt;
+  }
+  using detail::decode;
+  return decode_or_error(a, result);
+}
+
 // ======================================================================
 
 #endif /* fhiclcpp_coding_h */
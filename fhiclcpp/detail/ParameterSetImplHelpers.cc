@@ -1,5 +1,6 @@
 #include "fhiclcpp/detail/ParameterSetImplHelpers.h"
 #include "boost/algorithm/string.hpp"
+#include "cetlib/canonical_string.h"
 #include "cetlib/container_algorithms.h"
 #include "cetlib/split_by_regex.h"
 #include "fhiclcpp/coding.h"
@@ -112,4 +113,49 @@ namespace fhicl::detail {
 
     return find_an_any(++it, cend, a);
   }
+
+  //===============================================================
+  // UnescapedStringCache
+
+  UnescapedStringCache::UnescapedStringCache(UnescapedStringCache const&) {}
+
+  UnescapedStringCache::UnescapedStringCache(UnescapedStringCache&&) noexcept
+  {}
+
+  UnescapedStringCache&
+  UnescapedStringCache::operator=(UnescapedStringCache const&)
+  {
+    clear();
+    return *this;
+  }
+
+  // The ParameterSet being assigned to is not read concurrently, so no
+  // lock is needed.
+  UnescapedStringCache&
+  UnescapedStringCache::operator=(UnescapedStringCache&&) noexcept
+  {
+    unescaped_.clear();
+    return *this;
+  }
+
+  std::string_view
+  UnescapedStringCache::get(std::any const& value,
+                            std::string_view const escaped)
+  {
+    std::lock_guard sentry{mutex_};
+    auto it = unescaped_.find(&value);
+    if (it == unescaped_.end()) {
+      it = unescaped_
+             .emplace(&value, cet::unescape(std::string{escaped}))
+             .first;
+    }
+    return it->second;
+  }
+
+  void
+  UnescapedStringCache::clear()
+  {
+    std::lock_guard sentry{mutex_};
+    unescaped_.clear();
+  }
 }
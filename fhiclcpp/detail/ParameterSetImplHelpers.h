@@ -2,7 +2,10 @@
 #define fhiclcpp_detail_ParameterSetImplHelpers_h
 
 #include <any>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace fhicl::detail {
@@ -50,6 +53,31 @@ namespace fhicl::detail {
   bool find_an_any(std::vector<std::size_t>::const_iterator it,
                    std::vector<std::size_t>::const_iterator const cend,
                    std::any& a);
+
+  //===============================================================
+  // UnescapedStringCache
+  //
+  // Holds the unescaped forms of the string atoms of one
+  // ParameterSet, keyed by the address of the stored value, so that
+  // each atom is unescaped at most once.  Copies start out empty as
+  // the values of a copied ParameterSet live at different addresses;
+  // so do moved-to caches, which keeps moving a ParameterSet noexcept.
+
+  class UnescapedStringCache {
+  public:
+    UnescapedStringCache() = default;
+    UnescapedStringCache(UnescapedStringCache const&);
+    UnescapedStringCache(UnescapedStringCache&&) noexcept;
+    UnescapedStringCache& operator=(UnescapedStringCache const&);
+    UnescapedStringCache& operator=(UnescapedStringCache&&) noexcept;
+
+    std::string_view get(std::any const& value, std::string_view escaped);
+    void clear();
+
+  private:
+    std::mutex mutex_;
+    std::unordered_map<std::any const*, std::string> unescaped_;
+  };
 }
 
 #endif /* fhiclcpp_detail_ParameterSetImplHelpers_h */
@@ -0,0 +1,189 @@
+#include "fhiclcpp/detail/binary_blob.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/ParameterSetID.h"
+#include "fhiclcpp/exception.h"
+
+#include <any>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+using fhicl::ParameterSet;
+using fhicl::ParameterSetID;
+using fhicl::detail::binary_blob;
+
+namespace {
+  enum tag : unsigned char { atom_tag, sequence_tag, table_tag };
+
+  void
+  put_count(std::string& out, std::size_t n)
+  {
+    while (n >= 0x80) {
+      out.push_back(static_cast<char>((n & 0x7f) | 0x80));
+      n >>= 7;
+    }
+    out.push_back(static_cast<char>(n));
+  }
+
+  void
+  put_string(std::string& out, std::string_view const str)
+  {
+    put_count(out, str.size());
+    out.append(str);
+  }
+
+  void
+  put_value(std::string& out, std::any const& value)
+  {
+    using namespace fhicl::detail;
+    if (is_table(value)) {
+      out.push_back(table_tag);
+      auto const& digest = std::any_cast<ParameterSetID const&>(value).digest();
+      out.append(reinterpret_cast<char const*>(digest.data()), digest.size());
+    } else if (is_sequence(value)) {
+      auto const& seq = std::any_cast<ps_sequence_t const&>(value);
+      out.push_back(sequence_tag);
+      put_count(out, seq.size());
+      for (auto const& element : seq) {
+        put_value(out, element);
+      }
+    } else {
+      out.push_back(atom_tag);
+      put_string(out, std::any_cast<ps_atom_t const&>(value));
+    }
+  }
+
+  class reader {
+  public:
+    explicit reader(std::string_view const blob) noexcept : rest_{blob} {}
+
+    bool
+    done() const noexcept
+    {
+      return rest_.empty();
+    }
+
+    unsigned char
+    byte()
+    {
+      need(1);
+      auto const result = static_cast<unsigned char>(rest_.front());
+      rest_.remove_prefix(1);
+      return result;
+    }
+
+    std::size_t
+    count()
+    {
+      std::size_t result{};
+      for (unsigned shift{}; shift < 64; shift += 7) {
+        auto const b = byte();
+        result |= std::size_t{b & 0x7fu} << shift;
+        if ((b & 0x80) == 0) {
+          return result;
+        }
+      }
+      fail("count too large");
+    }
+
+    // The number of items that follow, each of which is encoded in at
+    // least one byte, so that a corrupt count is caught before
+    // anything is allocated for the items.
+    std::size_t
+    items()
+    {
+      auto const result = count();
+      if (result > rest_.size()) {
+        fail("count exceeds the remaining bytes");
+      }
+      return result;
+    }
+
+    std::string_view
+    bytes(std::size_t const n)
+    {
+      need(n);
+      auto const result = rest_.substr(0, n);
+      rest_.remove_prefix(n);
+      return result;
+    }
+
+    std::any
+    value()
+    {
+      switch (byte()) {
+      case atom_tag: {
+        auto const n = count();
+        return fhicl::detail::ps_atom_t{bytes(n)};
+      }
+      case sequence_tag: {
+        fhicl::detail::ps_sequence_t result(items());
+        for (auto& element : result) {
+          element = value();
+        }
+        return result;
+      }
+      case table_tag: {
+        cet::sha1::digest_t digest;
+        std::memcpy(digest.data(), bytes(digest.size()).data(), digest.size());
+        return ParameterSetID{digest};
+      }
+      }
+      fail("unknown value tag");
+    }
+
+    [[noreturn]] static void
+    fail(char const* what)
+    {
+      throw fhicl::exception{fhicl::error::parse_error,
+                             "Malformed binary ParameterSet blob: "}
+        << what << ".\n";
+    }
+
+  private:
+    void
+    need(std::size_t const n) const
+    {
+      if (rest_.size() < n) {
+        fail("unexpected end");
+      }
+    }
+
+    std::string_view rest_;
+  };
+}
+
+std::string
+binary_blob::encode(ParameterSet const& pset)
+{
+  std::string result;
+  result.push_back(static_cast<char>(version));
+  put_count(result, pset.mapping_.size());
+  for (auto const& [key, value] : pset.mapping_) {
+    put_string(result, key);
+    put_value(result, value);
+  }
+  return result;
+}
+
+ParameterSet
+binary_blob::decode(std::string_view const blob)
+{
+  reader in{blob};
+  if (auto const v = in.byte(); v != version) {
+    throw fhicl::exception{fhicl::error::parse_error,
+                           "Unsupported binary ParameterSet blob: "}
+      << "version " << static_cast<unsigned>(v) << ".\n";
+  }
+  ParameterSet result;
+  auto& mapping = result.mapping_;
+  for (auto n = in.items(); n != 0; --n) {
+    auto const key = in.bytes(in.count());
+    // Encoded in key order, so each member goes at the end.
+    mapping.emplace_hint(mapping.cend(), key, in.value());
+  }
+  if (!in.done()) {
+    reader::fail("trailing bytes");
+  }
+  return result;
+}
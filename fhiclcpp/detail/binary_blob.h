@@ -0,0 +1,45 @@
+#ifndef fhiclcpp_detail_binary_blob_h
+#define fhiclcpp_detail_binary_blob_h
+
+// ======================================================================
+//
+// binary_blob: Binary encoding of a ParameterSet, for storage in a
+//              ParameterSets table
+//
+//   blob     := version table
+//   table    := count member*              (members in key order)
+//   member   := string value
+//   value    := 0 string                   atom, as stored (e.g. "\"x\"")
+//             | 1 count value*             sequence
+//             | 2 digest                   table, by its 20-byte ID
+//   string   := count byte*
+//
+// 'version' is a single byte; counts are unsigned LEB128 varints.
+// Nested tables are always referred to by ID, so decoding involves
+// neither the parser nor the registry.
+//
+// ======================================================================
+
+#include "fhiclcpp/fwd.h"
+
+#include <string>
+#include <string_view>
+
+namespace fhicl::detail {
+  class binary_blob;
+}
+
+class fhicl::detail::binary_blob {
+public:
+  static constexpr unsigned char version{1};
+
+  static std::string encode(ParameterSet const& pset);
+  // Throws if the blob is malformed or of an unknown version.
+  static ParameterSet decode(std::string_view blob);
+};
+
+#endif /* fhiclcpp_detail_binary_blob_h */
+
+// Local Variables:
+// mode: c++
+// End:
@@ -0,0 +1,177 @@
+#include "fhiclcpp/detail/mapped_registry_file.h"
+#include "fhiclcpp/exception.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using fhicl::ParameterSetID;
+using fhicl::detail::mapped_registry_file;
+
+namespace {
+  constexpr std::array<char, 8> magic{{'F', 'H', 'I', 'C', 'L', 'R', 'E', 'G'}};
+  constexpr std::uint32_t byte_order_mark{0x01020304};
+
+  struct header {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t byte_order_mark;
+    std::uint64_t count;
+  };
+  static_assert(sizeof(header) == 24);
+
+  [[noreturn]] void
+  fail(fhicl::error const code, std::string const& filename, char const* what)
+  {
+    throw fhicl::exception{code, "Registry file "}
+      << filename << ": " << what << ".\n";
+  }
+}
+
+struct mapped_registry_file::index_entry {
+  cet::sha1::digest_t digest;
+  std::uint32_t size;
+  std::uint64_t offset;
+};
+
+mapped_registry_file::mapped_registry_file(std::string const& filename)
+  : filename_{filename}
+{
+  static_assert(sizeof(index_entry) == 32);
+  auto const fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    fail(error::cant_open_db, filename, std::strerror(errno));
+  }
+  struct stat st;
+  if (::fstat(fd, &st) == -1) {
+    ::close(fd);
+    fail(error::cant_open_db, filename, std::strerror(errno));
+  }
+  file_size_ = st.st_size;
+  if (file_size_ < sizeof(header)) {
+    ::close(fd);
+    fail(error::parse_error, filename, "too short");
+  }
+  auto* const mapped =
+    ::mmap(nullptr, file_size_, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED) {
+    fail(error::cant_open_db, filename, std::strerror(errno));
+  }
+  data_ = static_cast<char const*>(mapped);
+
+  header h;
+  std::memcpy(&h, data_, sizeof(h));
+  char const* problem = nullptr;
+  if (h.magic != magic) {
+    problem = "not a registry file";
+  } else if (h.byte_order_mark != byte_order_mark) {
+    problem = "written on a machine of other byte order";
+  } else if (h.version != version) {
+    problem = "unsupported version";
+  } else if (h.count > (file_size_ - sizeof(h)) / sizeof(index_entry)) {
+    problem = "truncated index";
+  }
+  if (problem) {
+    ::munmap(mapped, file_size_);
+    fail(error::parse_error, filename, problem);
+  }
+  size_ = h.count;
+  // The index starts at a multiple of its alignment; mmap returns
+  // page-aligned addresses.
+  index_ = reinterpret_cast<index_entry const*>(data_ + sizeof(h));
+}
+
+mapped_registry_file::~mapped_registry_file()
+{
+  ::munmap(const_cast<char*>(data_), file_size_);
+}
+
+std::size_t
+mapped_registry_file::size() const noexcept
+{
+  return size_;
+}
+
+std::optional<std::string_view>
+mapped_registry_file::find(ParameterSetID const& id) const
+{
+  auto const& digest = id.digest();
+  auto const end = index_ + size_;
+  auto const it = std::lower_bound(
+    index_, end, digest, [](index_entry const& e, auto const& d) {
+      return e.digest < d;
+    });
+  if (it == end || it->digest != digest) {
+    return std::nullopt;
+  }
+  return blob_(*it);
+}
+
+std::pair<ParameterSetID, std::string_view>
+mapped_registry_file::entry(std::size_t const i) const
+{
+  return {ParameterSetID{index_[i].digest}, blob_(index_[i])};
+}
+
+std::string_view
+mapped_registry_file::blob_(index_entry const& e) const
+{
+  if (e.offset > file_size_ || e.size > file_size_ - e.offset) {
+    fail(error::parse_error, filename_, "blob out of bounds");
+  }
+  return {data_ + e.offset, e.size};
+}
+
+void
+mapped_registry_file::write(
+  std::string const& filename,
+  std::vector<std::pair<ParameterSetID, std::string>> entries)
+{
+  std::sort(entries.begin(), entries.end(), [](auto const& a, auto const& b) {
+    return a.first < b.first;
+  });
+  entries.erase(std::unique(entries.begin(),
+                            entries.end(),
+                            [](auto const& a, auto const& b) {
+                              return a.first == b.first;
+                            }),
+                entries.end());
+
+  header const h{magic, version, byte_order_mark, entries.size()};
+  std::vector<index_entry> index;
+  index.reserve(entries.size());
+  std::uint64_t offset = sizeof(h) + entries.size() * sizeof(index_entry);
+  for (auto const& [id, blob] : entries) {
+    index.push_back(
+      {id.digest(), static_cast<std::uint32_t>(blob.size()), offset});
+    offset += blob.size();
+  }
+
+  auto const tmp = filename + ".tmp";
+  {
+    std::ofstream out{tmp, std::ios::binary | std::ios::trunc};
+    out.write(reinterpret_cast<char const*>(&h), sizeof(h));
+    out.write(reinterpret_cast<char const*>(index.data()),
+              index.size() * sizeof(index_entry));
+    for (auto const& entry : entries) {
+      out.write(entry.second.data(), entry.second.size());
+    }
+    if (!out.flush()) {
+      std::remove(tmp.c_str());
+      fail(error::cant_open_db, tmp, "write failed");
+    }
+  }
+  if (std::rename(tmp.c_str(), filename.c_str()) != 0) {
+    std::remove(tmp.c_str());
+    fail(error::cant_open_db, filename, std::strerror(errno));
+  }
+}
@@ -0,0 +1,77 @@
+#ifndef fhiclcpp_detail_mapped_registry_file_h
+#define fhiclcpp_detail_mapped_registry_file_h
+
+// ======================================================================
+//
+// mapped_registry_file: Read-only, memory-mapped file of ParameterSets
+//
+// The file is position-independent -- it refers to its contents only
+// by offset -- so that processes mapping the same file share its pages
+// through the page cache:
+//
+//   header   "FHICLREG", version (u32), byte-order mark (u32),
+//            number of entries (u64)
+//   index    one 32-byte entry per ParameterSet, sorted by ID:
+//            digest (20 bytes), blob size (u32), blob offset (u64)
+//   blobs    the ParameterSets, in the encoding of binary_blob.h
+//
+// Integers are in the byte order of the writing machine; a file
+// written on a machine of the other byte order is rejected.  'write'
+// creates the file under a temporary name and renames it, so that a
+// file being mapped is always complete.
+//
+// ======================================================================
+
+#include "fhiclcpp/ParameterSetID.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace fhicl::detail {
+  class mapped_registry_file;
+}
+
+class fhicl::detail::mapped_registry_file {
+public:
+  static constexpr std::uint32_t version{1};
+
+  // Throws if the file cannot be mapped or is not a registry file.
+  explicit mapped_registry_file(std::string const& filename);
+  ~mapped_registry_file();
+
+  mapped_registry_file(mapped_registry_file const&) = delete;
+  mapped_registry_file& operator=(mapped_registry_file const&) = delete;
+
+  std::size_t size() const noexcept;
+  // The binary blob of the ParameterSet with the given ID, if present.
+  std::optional<std::string_view> find(ParameterSetID const& id) const;
+  // The i-th entry, in order of ID.
+  std::pair<ParameterSetID, std::string_view> entry(std::size_t i) const;
+
+  // The blobs must be in the encoding of binary_blob.h.
+  static void write(
+    std::string const& filename,
+    std::vector<std::pair<ParameterSetID, std::string>> entries);
+
+private:
+  struct index_entry;
+
+  std::string_view blob_(index_entry const& e) const;
+
+  std::string filename_;
+  char const* data_{nullptr};
+  std::size_t file_size_{};
+  index_entry const* index_{nullptr};
+  std::size_t size_{};
+};
+
+#endif /* fhiclcpp_detail_mapped_registry_file_h */
+
+// Local Variables:
+// mode: c++
+// End:
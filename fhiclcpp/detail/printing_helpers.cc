@@ -1,4 +1,5 @@
 #include "fhiclcpp/detail/printing_helpers.h"
+#include "fhiclcpp/coding.h"
 #include "fhiclcpp/exception.h"
 
 #include <cassert>
@@ -100,8 +101,7 @@ std::string
 atom::value(std::any const& a)
 {
   using ps_atom_t = std::string;
-  std::string const str = std::any_cast<ps_atom_t>(a);
-  return str == std::string(9, '\0') ? "@nil" : str;
+  return is_nil(a) ? "@nil" : std::any_cast<ps_atom_t const&>(a);
 }
 
 //==================================================================
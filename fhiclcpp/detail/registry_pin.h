@@ -0,0 +1,75 @@
+#ifndef fhiclcpp_detail_registry_pin_h
+#define fhiclcpp_detail_registry_pin_h
+
+// ======================================================================
+//
+// registry_pin: Keeps an entry of the ParameterSetRegistry from being
+//               evicted for as long as any copy of the pin exists.
+//
+// Pins are obtained from a 'ParameterSetRegistry::handle'; unlike the
+// handle, a pin does not refer to the entry itself, so it may be held
+// by types (such as ValueView) declared before the registry.  A
+// default-constructed pin, or one obtained from a handle to an entry
+// that cannot be evicted, pins nothing.
+//
+// ======================================================================
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+namespace fhicl::detail {
+  class registry_pin {
+  public:
+    registry_pin() noexcept = default;
+    explicit registry_pin(std::atomic<std::uint32_t>* pins) noexcept;
+    registry_pin(registry_pin const& other) noexcept;
+    registry_pin(registry_pin&& other) noexcept;
+    registry_pin& operator=(registry_pin other) noexcept;
+    ~registry_pin();
+
+  private:
+    std::atomic<std::uint32_t>* pins_{nullptr};
+  };
+}
+
+// ======================================================================
+
+inline fhicl::detail::registry_pin::registry_pin(
+  std::atomic<std::uint32_t>* const pins) noexcept
+  : pins_{pins}
+{
+  if (pins_ != nullptr) {
+    ++*pins_;
+  }
+}
+
+inline fhicl::detail::registry_pin::registry_pin(
+  registry_pin const& other) noexcept
+  : registry_pin{other.pins_}
+{}
+
+inline fhicl::detail::registry_pin::registry_pin(registry_pin&& other) noexcept
+  : pins_{std::exchange(other.pins_, nullptr)}
+{}
+
+inline auto
+fhicl::detail::registry_pin::operator=(registry_pin other) noexcept
+  -> registry_pin&
+{
+  std::swap(pins_, other.pins_);
+  return *this;
+}
+
+inline fhicl::detail::registry_pin::~registry_pin()
+{
+  if (pins_ != nullptr) {
+    --*pins_;
+  }
+}
+
+#endif /* fhiclcpp_detail_registry_pin_h */
+
+// Local Variables:
+// mode: c++
+// End:
@@ -0,0 +1,378 @@
+// ======================================================================
+//
+// sha1
+//
+// Each accelerated backend provides a compression function that
+// processes whole 64-byte blocks; the message padding is common to
+// both of them.  The compression functions follow the reference
+// sequences published by Intel and ARM for their SHA instructions.
+// The portable backend is cet::sha1, which was used for all IDs
+// before the accelerated backends were introduced.
+//
+// ======================================================================
+
+#include "fhiclcpp/detail/sha1.h"
+#include "fhiclcpp/exception.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FHICLCPP_SHA1_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__)
+#if defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO)
+#define FHICLCPP_SHA1_ARMV8 1
+#define FHICLCPP_SHA1_ARMV8_TARGET
+#elif defined(__GNUC__) && !defined(__clang__)
+#define FHICLCPP_SHA1_ARMV8 1
+#define FHICLCPP_SHA1_ARMV8_TARGET __attribute__((target("+crypto")))
+#endif
+#endif
+
+#ifdef FHICLCPP_SHA1_ARMV8
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+#endif
+
+using namespace fhicl;
+using namespace fhicl::detail;
+
+namespace {
+
+  using compress_t = void (*)(std::uint32_t* state,
+                              unsigned char const* data,
+                              std::size_t n_blocks);
+
+#ifdef FHICLCPP_SHA1_X86
+  // ====================================================================
+  // x86 SHA extensions
+  //
+  // The 80 rounds are performed in 20 groups of four.  Group I uses
+  // message vector I % 4 and, while doing so, advances the schedule of
+  // the vectors needed by the following groups.
+
+#define FHICLCPP_SHA1_X86_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+
+  template <int I>
+  FHICLCPP_SHA1_X86_TARGET inline void
+  x86_group(__m128i& abcd, __m128i (&e)[2], __m128i (&msg)[4])
+  {
+    auto& e_cur = e[I % 2];
+    auto& e_next = e[(I + 1) % 2];
+    if constexpr (I == 0) {
+      e_cur = _mm_add_epi32(e_cur, msg[0]);
+    } else {
+      e_cur = _mm_sha1nexte_epu32(e_cur, msg[I % 4]);
+    }
+    e_next = abcd;
+    if constexpr (I >= 3 && I <= 18) {
+      msg[(I + 1) % 4] = _mm_sha1msg2_epu32(msg[(I + 1) % 4], msg[I % 4]);
+    }
+    abcd = _mm_sha1rnds4_epu32(abcd, e_cur, I / 5);
+    if constexpr (I >= 1 && I <= 16) {
+      msg[(I + 3) % 4] = _mm_sha1msg1_epu32(msg[(I + 3) % 4], msg[I % 4]);
+    }
+    if constexpr (I >= 2 && I <= 17) {
+      msg[(I + 2) % 4] = _mm_xor_si128(msg[(I + 2) % 4], msg[I % 4]);
+    }
+  }
+
+  template <std::size_t... I>
+  FHICLCPP_SHA1_X86_TARGET inline void
+  x86_groups(__m128i& abcd,
+             __m128i (&e)[2],
+             __m128i (&msg)[4],
+             unsigned char const* data,
+             std::index_sequence<I...>)
+  {
+    auto const mask =
+      _mm_set_epi64x(0x0001020304050607ull, 0x08090a0b0c0d0e0full);
+    for (int i = 0; i != 4; ++i) {
+      msg[i] = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 16 * i)),
+        mask);
+    }
+    (x86_group<I>(abcd, e, msg), ...);
+  }
+
+  FHICLCPP_SHA1_X86_TARGET void
+  compress_x86_sha_ni(std::uint32_t* state,
+                      unsigned char const* data,
+                      std::size_t n_blocks)
+  {
+    auto abcd = _mm_shuffle_epi32(
+      _mm_loadu_si128(reinterpret_cast<__m128i const*>(state)), 0x1B);
+    __m128i e[2]{_mm_set_epi32(state[4], 0, 0, 0), _mm_setzero_si128()};
+    __m128i msg[4];
+    for (; n_blocks != 0; --n_blocks, data += 64) {
+      auto const abcd_saved = abcd;
+      auto const e_saved = e[0];
+      x86_groups(abcd, e, msg, data, std::make_index_sequence<20>{});
+      // After an even number of groups, the next E is in e[0].
+      e[0] = _mm_sha1nexte_epu32(e[0], e_saved);
+      abcd = _mm_add_epi32(abcd, abcd_saved);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state),
+                     _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = _mm_extract_epi32(e[0], 3);
+  }
+
+  bool
+  x86_sha_ni_supported() noexcept
+  {
+    unsigned eax{}, ebx{}, ecx{}, edx{};
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+      return false;
+    }
+    bool const ssse3 = ecx & bit_SSSE3;
+    bool const sse41 = ecx & bit_SSE4_1;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+      return false;
+    }
+    bool const sha = ebx & (1u << 29);
+    return ssse3 && sse41 && sha;
+  }
+#endif
+
+#ifdef FHICLCPP_SHA1_ARMV8
+  // ====================================================================
+  // ARMv8 SHA extensions
+  //
+  // As for x86, the rounds are performed in 20 groups of four.  The
+  // message words for group I, with the round constant added, are
+  // prepared two groups in advance.
+
+  template <int I>
+  FHICLCPP_SHA1_ARMV8_TARGET inline uint32x4_t
+  round_constant()
+  {
+    constexpr std::uint32_t k[]{
+      0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xCA62C1D6};
+    return vdupq_n_u32(k[I / 5]);
+  }
+
+  template <int I>
+  FHICLCPP_SHA1_ARMV8_TARGET inline void
+  armv8_group(uint32x4_t& abcd,
+              std::uint32_t (&e)[2],
+              uint32x4_t (&tmp)[2],
+              uint32x4_t (&msg)[4])
+  {
+    e[(I + 1) % 2] = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    if constexpr (I < 5) {
+      abcd = vsha1cq_u32(abcd, e[I % 2], tmp[I % 2]);
+    } else if constexpr (I >= 10 && I < 15) {
+      abcd = vsha1mq_u32(abcd, e[I % 2], tmp[I % 2]);
+    } else {
+      abcd = vsha1pq_u32(abcd, e[I % 2], tmp[I % 2]);
+    }
+    if constexpr (I <= 17) {
+      tmp[I % 2] = vaddq_u32(msg[(I + 2) % 4], round_constant<I + 2>());
+    }
+    if constexpr (I >= 1 && I <= 16) {
+      msg[(I + 3) % 4] = vsha1su1q_u32(msg[(I + 3) % 4], msg[(I + 2) % 4]);
+    }
+    if constexpr (I <= 15) {
+      msg[I % 4] =
+        vsha1su0q_u32(msg[I % 4], msg[(I + 1) % 4], msg[(I + 2) % 4]);
+    }
+  }
+
+  template <std::size_t... I>
+  FHICLCPP_SHA1_ARMV8_TARGET inline void
+  armv8_groups(uint32x4_t& abcd,
+               std::uint32_t (&e)[2],
+               unsigned char const* data,
+               std::index_sequence<I...>)
+  {
+    uint32x4_t msg[4];
+    for (int i = 0; i != 4; ++i) {
+      msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16 * i)));
+    }
+    uint32x4_t tmp[2]{vaddq_u32(msg[0], round_constant<0>()),
+                      vaddq_u32(msg[1], round_constant<1>())};
+    (armv8_group<I>(abcd, e, tmp, msg), ...);
+  }
+
+  FHICLCPP_SHA1_ARMV8_TARGET void
+  compress_armv8_sha(std::uint32_t* state,
+                     unsigned char const* data,
+                     std::size_t n_blocks)
+  {
+    auto abcd = vld1q_u32(state);
+    std::uint32_t e[2]{state[4], 0};
+    for (; n_blocks != 0; --n_blocks, data += 64) {
+      auto const abcd_saved = abcd;
+      auto const e_saved = e[0];
+      armv8_groups(abcd, e, data, std::make_index_sequence<20>{});
+      e[0] += e_saved;
+      abcd = vaddq_u32(abcd, abcd_saved);
+    }
+    vst1q_u32(state, abcd);
+    state[4] = e[0];
+  }
+
+  bool
+  armv8_sha_supported() noexcept
+  {
+#if defined(__APPLE__)
+    return true;
+#elif defined(__linux__) && defined(HWCAP_SHA1)
+    return getauxval(AT_HWCAP) & HWCAP_SHA1;
+#else
+    return false;
+#endif
+  }
+#endif
+
+  // ====================================================================
+
+  sha1_digest_t
+  hash(std::string_view const data, compress_t const compress) noexcept
+  {
+    std::uint32_t state[5]{
+      0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    auto const bytes = reinterpret_cast<unsigned char const*>(data.data());
+    auto const n_blocks = data.size() / 64;
+    compress(state, bytes, n_blocks);
+
+    // Padding: a one bit, zeros, and the message length in bits, in
+    // one or two final blocks.
+    unsigned char tail[128]{};
+    auto const n_remaining = data.size() % 64;
+    std::memcpy(tail, bytes + 64 * n_blocks, n_remaining);
+    tail[n_remaining] = 0x80;
+    std::size_t const n_tail_blocks = n_remaining < 56 ? 1 : 2;
+    auto const n_bits = std::uint64_t{data.size()} * 8;
+    for (int i = 0; i != 8; ++i) {
+      tail[64 * n_tail_blocks - 1 - i] = (n_bits >> (8 * i)) & 0xff;
+    }
+    compress(state, tail, n_tail_blocks);
+
+    sha1_digest_t result;
+    for (int i = 0; i != 5; ++i) {
+      result[4 * i] = state[i] >> 24;
+      result[4 * i + 1] = (state[i] >> 16) & 0xff;
+      result[4 * i + 2] = (state[i] >> 8) & 0xff;
+      result[4 * i + 3] = state[i] & 0xff;
+    }
+    return result;
+  }
+
+  // The CPU is queried only once per backend; doing so can be
+  // expensive (e.g. 'cpuid' traps under some hypervisors).
+  compress_t
+  compress_for(sha1_backend const backend) noexcept
+  {
+    switch (backend) {
+#ifdef FHICLCPP_SHA1_X86
+    case sha1_backend::x86_sha_ni: {
+      static bool const supported{x86_sha_ni_supported()};
+      return supported ? compress_x86_sha_ni : nullptr;
+    }
+#endif
+#ifdef FHICLCPP_SHA1_ARMV8
+    case sha1_backend::armv8_sha: {
+      static bool const supported{armv8_sha_supported()};
+      return supported ? compress_armv8_sha : nullptr;
+    }
+#endif
+    default:
+      return nullptr;
+    }
+  }
+
+  sha1_digest_t
+  portable_sha1(std::string_view const data)
+  {
+    cet::sha1 sha{std::string{data}};
+    return sha.digest();
+  }
+
+  sha1_backend
+  select_backend() noexcept
+  {
+    for (auto const backend :
+         {sha1_backend::x86_sha_ni, sha1_backend::armv8_sha}) {
+      if (compress_for(backend) != nullptr) {
+        return backend;
+      }
+    }
+    return sha1_backend::portable;
+  }
+
+  // Function-local statics so that IDs may be computed during static
+  // initialization of other translation units.
+  sha1_backend
+  default_backend() noexcept
+  {
+    static sha1_backend const backend{select_backend()};
+    return backend;
+  }
+
+  compress_t
+  default_compress() noexcept
+  {
+    static compress_t const compress{compress_for(default_backend())};
+    return compress;
+  }
+}
+
+// ======================================================================
+
+bool
+fhicl::detail::sha1_backend_available(sha1_backend const backend) noexcept
+{
+  return backend == sha1_backend::portable || compress_for(backend) != nullptr;
+}
+
+sha1_backend
+fhicl::detail::sha1_default_backend() noexcept
+{
+  return default_backend();
+}
+
+char const*
+fhicl::detail::to_string(sha1_backend const backend) noexcept
+{
+  switch (backend) {
+  case sha1_backend::x86_sha_ni:
+    return "x86_sha_ni";
+  case sha1_backend::armv8_sha:
+    return "armv8_sha";
+  default:
+    return "portable";
+  }
+}
+
+sha1_digest_t
+fhicl::detail::sha1(std::string_view const data)
+{
+  auto const compress = default_compress();
+  return compress != nullptr ? hash(data, compress) : portable_sha1(data);
+}
+
+sha1_digest_t
+fhicl::detail::sha1(std::string_view const data, sha1_backend const backend)
+{
+  if (backend == sha1_backend::portable) {
+    return portable_sha1(data);
+  }
+  auto const compress = compress_for(backend);
+  if (compress == nullptr) {
+    throw exception(error::unimplemented)
+      << "The " << to_string(backend)
+      << " SHA-1 backend is not available on this platform.\n";
+  }
+  return hash(data, compress);
+}
@@ -0,0 +1,43 @@
+#ifndef fhiclcpp_detail_sha1_h
+#define fhiclcpp_detail_sha1_h
+
+// ======================================================================
+//
+// sha1: SHA-1 digests for ParameterSetIDs
+//
+// The digest is computed by the fastest backend supported by the CPU
+// on which the program runs, as determined once at run time:
+//
+//   x86_sha_ni   x86-64 SHA extensions (with SSSE3 and SSE4.1)
+//   armv8_sha    ARMv8 cryptographic extensions
+//   portable     cet::sha1, always available
+//
+// All backends produce the same digests.
+//
+// ======================================================================
+
+#include "cetlib/sha1.h"
+
+#include <string_view>
+
+namespace fhicl::detail {
+
+  enum class sha1_backend { portable, x86_sha_ni, armv8_sha };
+
+  using sha1_digest_t = cet::sha1::digest_t;
+
+  // Whether the backend was compiled in and is supported by the CPU.
+  bool sha1_backend_available(sha1_backend backend) noexcept;
+  sha1_backend sha1_default_backend() noexcept;
+  char const* to_string(sha1_backend backend) noexcept;
+
+  sha1_digest_t sha1(std::string_view data);
+  // Throws if the backend is not available.
+  sha1_digest_t sha1(std::string_view data, sha1_backend backend);
+}
+
+#endif /* fhiclcpp_detail_sha1_h */
+
+// Local Variables:
+// mode: c++
+// End:
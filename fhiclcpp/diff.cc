@@ -0,0 +1,151 @@
+// ======================================================================
+//
+// diff
+//
+// ======================================================================
+
+#include "fhiclcpp/diff.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/ValueView.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+using namespace fhicl;
+
+namespace {
+
+  // A value together with the ParameterSet holding its source
+  // information, and the key under which that information is stored.
+  struct located_value {
+    ValueView value;
+    ParameterSet const* owner;
+    std::string key;
+
+    located_value
+    element(std::size_t const i) const
+    {
+      return {value[i], owner, key + '[' + std::to_string(i) + ']'};
+    }
+
+    std::string
+    src() const
+    {
+      return owner->get_src_info(key);
+    }
+  };
+
+  class differ {
+  public:
+    void compare_tables(std::string const& prefix,
+                        ParameterSet const& from,
+                        ParameterSet const& to);
+
+    std::vector<difference>
+    release()
+    {
+      return std::move(result_);
+    }
+
+  private:
+    void compare_values(std::string const& key,
+                        located_value const& from,
+                        located_value const& to);
+    void
+    added(std::string const& key, located_value const& to)
+    {
+      result_.push_back(
+        {difference_kind::added, key, {}, to.value.to_string(), {}, to.src()});
+    }
+    void
+    removed(std::string const& key, located_value const& from)
+    {
+      result_.push_back({difference_kind::removed,
+                         key,
+                         from.value.to_string(),
+                         {},
+                         from.src(),
+                         {}});
+    }
+
+    std::vector<difference> result_;
+  };
+
+  void
+  differ::compare_tables(std::string const& prefix,
+                         ParameterSet const& from,
+                         ParameterSet const& to)
+  {
+    auto const from_members = from.members();
+    auto const to_members = to.members();
+    auto f = from_members.begin();
+    auto t = to_members.begin();
+    auto const f_end = from_members.end();
+    auto const t_end = to_members.end();
+    while (f != f_end || t != t_end) {
+      if (t == t_end || (f != f_end && (*f).first < (*t).first)) {
+        auto const [name, value] = *f++;
+        removed(prefix + std::string{name}, {value, &from, std::string{name}});
+      } else if (f == f_end || (*t).first < (*f).first) {
+        auto const [name, value] = *t++;
+        added(prefix + std::string{name}, {value, &to, std::string{name}});
+      } else {
+        auto const [name, from_value] = *f++;
+        auto const to_value = (*t++).second;
+        std::string const key{name};
+        compare_values(
+          prefix + key, {from_value, &from, key}, {to_value, &to, key});
+      }
+    }
+  }
+
+  void
+  differ::compare_values(std::string const& key,
+                         located_value const& from,
+                         located_value const& to)
+  {
+    auto const& a = from.value;
+    auto const& b = to.value;
+    if (a.is_table() && b.is_table()) {
+      if (a.table().id() != b.table().id()) {
+        compare_tables(key + '.', a.table(), b.table());
+      }
+      return;
+    }
+    if (a.is_sequence() && b.is_sequence()) {
+      auto const n_from = a.size();
+      auto const n_to = b.size();
+      for (std::size_t i{}, n = std::max(n_from, n_to); i != n; ++i) {
+        auto const element_key = key + '[' + std::to_string(i) + ']';
+        if (i >= n_to) {
+          removed(element_key, from.element(i));
+        } else if (i >= n_from) {
+          added(element_key, to.element(i));
+        } else {
+          compare_values(element_key, from.element(i), to.element(i));
+        }
+      }
+      return;
+    }
+    auto from_string = a.to_string();
+    auto to_string = b.to_string();
+    if (a.kind() == b.kind() && from_string == to_string) {
+      return;
+    }
+    result_.push_back({difference_kind::changed,
+                       key,
+                       std::move(from_string),
+                       std::move(to_string),
+                       from.src(),
+                       to.src()});
+  }
+}
+
+std::vector<difference>
+fhicl::diff(ParameterSet const& from, ParameterSet const& to)
+{
+  differ d;
+  d.compare_tables({}, from, to);
+  return d.release();
+}
@@ -0,0 +1,52 @@
+#ifndef fhiclcpp_diff_h
+#define fhiclcpp_diff_h
+
+// ======================================================================
+//
+// diff: Structural differences between two ParameterSets
+//
+// 'fhicl::diff(from, to)' returns the keys that were added, removed,
+// or changed in going from one configuration to the other, in
+// canonical key order.  Keys are given as full paths (e.g.
+// "physics.producers.a.labels[1]").  Tables present in both
+// configurations are descended only if their ParameterSetIDs differ,
+// so identical subtrees are skipped without being visited; the cost is
+// driven by the size of the difference rather than that of the
+// configurations.
+//
+// A table or sequence that exists only on one side is reported as a
+// single difference; a sequence whose length changed is reported
+// element by element.  A value whose kind changed (e.g. an atom that
+// became a table) is reported as changed.
+//
+// ======================================================================
+
+#include "fhiclcpp/fwd.h"
+
+#include <string>
+#include <vector>
+
+namespace fhicl {
+  enum class difference_kind { added, removed, changed };
+
+  struct difference {
+    difference_kind kind;
+    std::string key;
+    // FHiCL representations of the values; empty if absent.
+    std::string from_value;
+    std::string to_value;
+    // Source information (see 'ParameterSet::get_src_info'); empty if
+    // absent or unavailable.
+    std::string from_src;
+    std::string to_src;
+  };
+
+  std::vector<difference> diff(ParameterSet const& from,
+                               ParameterSet const& to);
+}
+
+#endif /* fhiclcpp_diff_h */
+
+// Local Variables:
+// mode: c++
+// End:
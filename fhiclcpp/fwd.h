@@ -9,9 +9,12 @@
 
 namespace fhicl {
 
+  class FrozenParameterSet;
+  class FrozenValue;
   class ParameterSet;
   class ParameterSetID;
   class ParameterSetWalker;
+  class ValueView;
   class extended_value;
   class intermediate_table;
 }
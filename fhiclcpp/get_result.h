@@ -0,0 +1,105 @@
+#ifndef fhiclcpp_get_result_h
+#define fhiclcpp_get_result_h
+
+// ======================================================================
+//
+// get_result: Value-or-error result of 'ParameterSet::try_get' and
+//             'ValueView::try_as'.
+//
+// Unlike 'ParameterSet::get', the try_ functions report failures
+// through a get_error code instead of throwing, so that they may be
+// used for inexpensive probing:
+//
+//   if (auto const files = pset.try_get<std::vector<std::string>>("files")) {
+//     for (auto const& file : *files) {
+//       ...
+//     }
+//   } else if (files.error() == fhicl::get_error::type_mismatch) {
+//     ...
+//   }
+//
+// ======================================================================
+
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace fhicl {
+  enum class get_error {
+    missing,       // No value for the requested key.
+    type_mismatch, // The value cannot be represented as the requested type.
+    out_of_range   // Numeric value outside the range of the requested type.
+  };
+
+  template <class T>
+  class get_result;
+}
+
+// ----------------------------------------------------------------------
+
+template <class T>
+class fhicl::get_result {
+  static_assert(!std::is_same_v<T, get_error>);
+
+public:
+  get_result(T value) : value_{std::in_place_index<0>, std::move(value)} {}
+  get_result(get_error const error) noexcept
+    : value_{std::in_place_index<1>, error}
+  {}
+
+  bool
+  has_value() const noexcept
+  {
+    return value_.index() == 0;
+  }
+  explicit operator bool() const noexcept { return has_value(); }
+
+  // The value accessors throw std::bad_variant_access if there is no
+  // value; 'error()' does so if there is a value.
+  T const&
+  value() const&
+  {
+    return std::get<0>(value_);
+  }
+  T&
+  value() &
+  {
+    return std::get<0>(value_);
+  }
+  T&&
+  value() &&
+  {
+    return std::get<0>(std::move(value_));
+  }
+
+  T const& operator*() const& { return value(); }
+  T& operator*() & { return value(); }
+  T&& operator*() && { return std::move(*this).value(); }
+  T const* operator->() const { return &value(); }
+  T* operator->() { return &value(); }
+
+  get_error
+  error() const
+  {
+    return std::get<1>(value_);
+  }
+
+  template <class U>
+  T
+  value_or(U&& default_value) const&
+  {
+    return has_value() ? value() :
+                         static_cast<T>(std::forward<U>(default_value));
+  }
+
+private:
+  std::variant<T, get_error> value_;
+};
+
+// ======================================================================
+
+#endif /* fhiclcpp_get_result_h */
+
+// Local Variables:
+// mode: c++
+// End:
@@ -122,7 +122,7 @@ namespace {
     check_protection(name, v);
   }
 
-  std::string
+  std::string const&
   canon_nil()
   {
     static std::string const canon_nil(9, '\0');
@@ -55,4 +55,17 @@ BOOST_AUTO_TEST_CASE(nested_vector)
   BOOST_TEST(records.size() == 3ul);
 }
 
+BOOST_AUTO_TEST_CASE(mixed_vector)
+{
+  std::vector<std::string> records;
+  std::vector<std::string> hashes;
+
+  // Only sequences of tables are decomposed.
+  auto const p =
+    fhicl::ParameterSet::make("a: [1, { b: 1 }] c: [{ d: 1 }, { d: 2 }]");
+  fhicl::decompose_parameterset(p, records, hashes);
+  BOOST_TEST(records.size() == hashes.size());
+  BOOST_TEST(records.size() == 3ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,211 @@
+#define BOOST_TEST_MODULE (FrozenParameterSet test)
+#include "boost/test/unit_test.hpp"
+
+#include "fhiclcpp/FrozenParameterSet.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/test/boost_test_print_pset.h"
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace fhicl;
+using namespace std::string_literals;
+
+namespace {
+  auto const config = "a: 7 "
+                      "b: @nil "
+                      "c: true "
+                      "d: -2.5e3 "
+                      "e: \"x\\\"y\" "
+                      "big: 5000000000 "
+                      "s: [1, 2, [3, 4]] "
+                      "t: { u: hello v: { w: [ {x: 1}, {x: 2} ] } } "
+                      "empty: {} "
+                      "none: []"s;
+
+  // Forwards to the default resource, keeping track of the number of
+  // bytes currently allocated.
+  class counting_resource : public std::pmr::memory_resource {
+  public:
+    std::size_t allocations{};
+    std::size_t bytes_in_use{};
+
+  private:
+    void*
+    do_allocate(std::size_t const bytes, std::size_t const alignment) override
+    {
+      ++allocations;
+      bytes_in_use += bytes;
+      return std::pmr::get_default_resource()->allocate(bytes, alignment);
+    }
+    void
+    do_deallocate(void* p,
+                  std::size_t const bytes,
+                  std::size_t const alignment) override
+    {
+      bytes_in_use -= bytes;
+      std::pmr::get_default_resource()->deallocate(p, bytes, alignment);
+    }
+    bool
+    do_is_equal(memory_resource const& other) const noexcept override
+    {
+      return this == &other;
+    }
+  };
+}
+
+BOOST_AUTO_TEST_SUITE(frozen_test)
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+  auto const pset = ParameterSet::make(config);
+  auto const frozen = freeze(pset);
+  BOOST_TEST(frozen.id() == pset.id());
+  BOOST_TEST(frozen.thaw() == pset);
+  BOOST_TEST(frozen.thaw().id() == pset.id());
+  BOOST_TEST(frozen.thaw().to_string() == pset.to_string());
+  BOOST_TEST(freeze(frozen.thaw()).id() == pset.id());
+
+  FrozenParameterSet const empty;
+  BOOST_TEST(empty.id() == ParameterSet{}.id());
+  BOOST_TEST(empty.root().empty());
+  BOOST_TEST(empty.thaw().is_empty());
+}
+
+BOOST_AUTO_TEST_CASE(retrieval)
+{
+  auto const frozen = freeze(ParameterSet::make(config));
+  BOOST_TEST(frozen.get<int>("a") == 7);
+  BOOST_TEST(frozen.get<std::string>("a") == "7");
+  BOOST_TEST(frozen.get<bool>("c"));
+  BOOST_TEST(frozen.get<double>("d") == -2500.);
+  BOOST_TEST(frozen.get<int>("d") == -2500);
+  BOOST_TEST(frozen.get<std::string>("e") == "x\"y");
+  BOOST_TEST(frozen.get_view("e") == "x\"y");
+  BOOST_TEST(frozen.get_view("t.u") == "hello");
+  BOOST_TEST(frozen.get<long long>("big") == 5000000000ll);
+  BOOST_TEST(frozen.get<int>("s[2][1]") == 4);
+  BOOST_TEST(frozen.get<int>("t.v.w[1].x") == 2);
+  BOOST_TEST((frozen.get<std::vector<int>>("s[2]") == std::vector{3, 4}));
+  BOOST_TEST((frozen.get<std::array<int, 2>>("s[2]") ==
+              std::array<int, 2>{3, 4}));
+  BOOST_TEST(frozen.get<ParameterSet>("t.v") ==
+             ParameterSet::make(config).get<ParameterSet>("t.v"));
+  BOOST_TEST(frozen.get<std::vector<ParameterSet>>("t.v.w").size() == 2ull);
+  BOOST_TEST(frozen.get<std::nullptr_t>("b") == nullptr);
+
+  BOOST_TEST(frozen.has_key("t.v.w[0].x"));
+  BOOST_TEST(!frozen.has_key("t.v.w[2].x"));
+  BOOST_TEST(!frozen.has_key("a.b"));
+  BOOST_TEST(!frozen.has_key("t..u"));
+  BOOST_TEST(!frozen.has_key("t."));
+  BOOST_TEST(!frozen.has_key("s[x]"));
+  BOOST_TEST(!frozen.has_key("s[]"));
+
+  BOOST_TEST((frozen.try_get<int>("z").error() == get_error::missing));
+  BOOST_TEST((frozen.try_get<int>("t").error() == get_error::type_mismatch));
+  BOOST_TEST((frozen.try_get<bool>("a").error() == get_error::type_mismatch));
+  BOOST_TEST((frozen.try_get<int>("big").error() == get_error::out_of_range));
+  BOOST_TEST(
+    (frozen.try_get<std::string>("b").error() == get_error::type_mismatch));
+
+  BOOST_CHECK_EXCEPTION(
+    frozen.get<int>("z"), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == cant_find;
+    });
+  BOOST_CHECK_EXCEPTION(
+    frozen.get<int>("t.u"), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == type_mismatch;
+    });
+}
+
+BOOST_AUTO_TEST_CASE(agrees_with_parameter_set)
+{
+  auto const pset = ParameterSet::make(config);
+  auto const frozen = freeze(pset);
+  for (auto const& key : pset.get_all_keys()) {
+    BOOST_TEST(frozen.has_key(key), key);
+    auto const as_int = pset.try_get<int>(key);
+    auto const frozen_int = frozen.try_get<int>(key);
+    BOOST_TEST(as_int.has_value() == frozen_int.has_value(), key);
+    if (as_int && frozen_int) {
+      BOOST_TEST(*as_int == *frozen_int, key);
+    }
+    auto const as_string = pset.try_get<std::string>(key);
+    auto const frozen_string = frozen.try_get<std::string>(key);
+    BOOST_TEST(as_string.has_value() == frozen_string.has_value(), key);
+    if (as_string && frozen_string) {
+      BOOST_TEST(*as_string == *frozen_string, key);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(iteration)
+{
+  auto const frozen = freeze(ParameterSet::make(config));
+  std::vector<std::string_view> keys;
+  for (auto const& member : frozen) {
+    keys.push_back(member.key());
+  }
+  auto const names = ParameterSet::make(config).get_names();
+  BOOST_TEST(
+    (keys == std::vector<std::string_view>(names.begin(), names.end())));
+
+  int sum{};
+  for (auto const& table : frozen.lookup("t.v.w")) {
+    sum += table["x"].as<int>();
+  }
+  BOOST_TEST(sum == 3);
+  BOOST_TEST(frozen.lookup("empty").is_table());
+  BOOST_TEST(frozen.lookup("empty").empty());
+  BOOST_TEST(frozen.lookup("none").is_sequence());
+  BOOST_TEST((frozen.lookup("none").begin() == frozen.lookup("none").end()));
+  BOOST_TEST((frozen.lookup("a").begin() == frozen.lookup("a").end()));
+}
+
+BOOST_AUTO_TEST_CASE(memory_resource)
+{
+  auto const pset = ParameterSet::make(config);
+  counting_resource resource;
+  {
+    auto const frozen = freeze(pset, &resource);
+    auto const copy = frozen;
+    // The block and the shared-ownership bookkeeping.
+    BOOST_TEST(resource.allocations == 2ull);
+    BOOST_TEST(resource.bytes_in_use >= frozen.size_in_bytes());
+    BOOST_TEST(copy.get<int>("t.v.w[1].x") == 2);
+    BOOST_TEST(copy.thaw() == pset);
+  }
+  BOOST_TEST(resource.bytes_in_use == 0ull);
+
+  std::pmr::monotonic_buffer_resource arena;
+  auto const frozen = freeze(pset, &arena);
+  BOOST_TEST(frozen.get_view("e") == "x\"y");
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_reads)
+{
+  auto const frozen = freeze(ParameterSet::make(config));
+  std::vector<std::thread> threads;
+  std::vector<int> sums(4);
+  for (std::size_t i = 0; i != sums.size(); ++i) {
+    threads.emplace_back([&frozen, &sum = sums[i]] {
+      for (int j = 0; j != 1000; ++j) {
+        sum += frozen.get<int>("t.v.w[1].x") + frozen.get<int>("a");
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto const sum : sums) {
+    BOOST_TEST(sum == 9000);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,15 +4,20 @@
 
 #include "cetlib/container_algorithms.h"
 #include "fhiclcpp/ParameterSetRegistry.h"
+#include "fhiclcpp/detail/binary_blob.h"
+#include "fhiclcpp/detail/mapped_registry_file.h"
 #include "fhiclcpp/test/boost_test_print_pset.h"
 #include "hep_concurrency/simultaneous_function_spawner.h"
 
 #include "sqlite3.h"
 
 #include <atomic>
+#include <cstdio>
 #include <functional>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -241,4 +246,681 @@ BOOST_AUTO_TEST_CASE(TestExport)
   sqlite3_close(db);
 }
 
+BOOST_AUTO_TEST_CASE(Batch)
+{
+  auto const initial_size = ParameterSetRegistry::size();
+  auto const visible_elsewhere = [](ParameterSetID const& id) {
+    bool result{};
+    std::thread t{[&result, &id] { result = ParameterSetRegistry::has(id); }};
+    t.join();
+    return result;
+  };
+
+  auto const pset = ParameterSet::make("batched: { a: { b: 1 } }");
+  BOOST_TEST(ParameterSetRegistry::size() == initial_size + 2);
+  BOOST_TEST(visible_elsewhere(pset.get<ParameterSet>("batched.a").id()));
+
+  ParameterSetID id;
+  {
+    ParameterSetRegistry::batch outer;
+    {
+      ParameterSetRegistry::batch inner;
+      id = ParameterSetRegistry::put(pset);
+      inner.publish();
+    }
+    // Only the outermost batch publishes.
+    BOOST_TEST(ParameterSetRegistry::has(id));
+    BOOST_TEST(ParameterSetRegistry::get(id) == pset);
+    BOOST_TEST(ParameterSetRegistry::size() == initial_size + 2);
+    BOOST_TEST(!visible_elsewhere(id));
+    {
+      ParameterSetRegistry::batch const unbatched{false};
+      BOOST_TEST(ParameterSetRegistry::size() == initial_size + 3);
+      BOOST_TEST(visible_elsewhere(id));
+      ParameterSetRegistry::put(ParameterSet::make("unbatched: 1"));
+      BOOST_TEST(ParameterSetRegistry::size() == initial_size + 4);
+    }
+    ParameterSetRegistry::put(ParameterSet::make("batched_again: 1"));
+    BOOST_TEST(ParameterSetRegistry::size() == initial_size + 4);
+    outer.publish();
+  }
+  BOOST_TEST(ParameterSetRegistry::size() == initial_size + 5);
+
+  // What is not published is discarded.
+  {
+    ParameterSetRegistry::batch const unpublished;
+    id = ParameterSetRegistry::put(ParameterSet::make("unpublished: 1"));
+    BOOST_TEST(ParameterSetRegistry::has(id));
+  }
+  BOOST_TEST(!ParameterSetRegistry::has(id));
+  BOOST_TEST(ParameterSetRegistry::size() == initial_size + 5);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentPutAndGet)
+{
+  auto const initial_size = ParameterSetRegistry::size();
+  constexpr unsigned n_threads{8};
+  constexpr unsigned n_psets{200};
+  vector<vector<ParameterSetID>> ids(n_threads);
+  // Boost.Test assertions are not thread-safe.
+  atomic<unsigned> mismatches{};
+  {
+    vector<function<void()>> tasks;
+    for (unsigned t = 0; t != n_threads; ++t) {
+      tasks.push_back([&ids, &mismatches, t] {
+        for (unsigned i = 0; i != n_psets; ++i) {
+          // Every thread registers the same ParameterSets.
+          ParameterSet ps;
+          ps.put("i", i);
+          auto const& id = ParameterSetRegistry::put(ps);
+          if (ParameterSetRegistry::get(id).get<unsigned>("i") != i) {
+            ++mismatches;
+          }
+          ids[t].push_back(id);
+        }
+      });
+    }
+    simultaneous_function_spawner sfs{tasks};
+  }
+  BOOST_TEST(mismatches == 0u);
+  BOOST_TEST(ParameterSetRegistry::size() == initial_size + n_psets);
+  for (auto const& thread_ids : ids) {
+    BOOST_TEST(thread_ids == ids.front());
+  }
+  BOOST_TEST(ParameterSetRegistry::take_snapshot().size() ==
+             initial_size + n_psets);
+}
+
+BOOST_AUTO_TEST_CASE(Snapshot)
+{
+  auto const before = ParameterSetRegistry::take_snapshot();
+  BOOST_TEST(before.size() == ParameterSetRegistry::size());
+
+  auto const pset = ParameterSet::make("snapshot: { a: { b: 2 } }");
+  auto const after = ParameterSetRegistry::take_snapshot();
+  BOOST_TEST(before.size() == after.size() - 2);
+  BOOST_TEST(after.size() == ParameterSetRegistry::size());
+
+  // Entries appear in order of registration.
+  auto const a_id = pset.get<ParameterSet>("snapshot.a").id();
+  auto const snapshot_id = pset.get<ParameterSet>("snapshot").id();
+  vector<ParameterSetID> ids;
+  for (auto const& [id, ps] : after) {
+    BOOST_TEST(ps.id() == id);
+    ids.push_back(id);
+  }
+  BOOST_TEST((vector(ids.end() - 2, ids.end()) ==
+              vector<ParameterSetID>{a_id, snapshot_id}));
+
+  // Iterating does not prevent other threads from putting entries.
+  atomic<bool> done{false};
+  thread writer{[&done] {
+    for (int i = 0; i != 1000; ++i) {
+      ParameterSet ps;
+      ps.put("snapshot_writer", i);
+      ParameterSetRegistry::put(ps);
+    }
+    done = true;
+  }};
+  size_t n{};
+  while (!done) {
+    n = 0;
+    for (auto const& entry : ParameterSetRegistry::take_snapshot()) {
+      n += entry.second.is_empty() ? 0 : 1;
+    }
+  }
+  writer.join();
+  BOOST_TEST(n <= ParameterSetRegistry::size());
+  BOOST_TEST(ParameterSetRegistry::take_snapshot().size() ==
+             after.size() + 1000);
+  BOOST_TEST(after.size() == before.size() + 2);
+}
+
+BOOST_AUTO_TEST_CASE(IncrementalExport)
+{
+  sqlite3* db = nullptr;
+  BOOST_TEST_REQUIRE(!sqlite3_open(":memory:", &db));
+  auto const count = [db] {
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(
+      db, "SELECT COUNT(*) from ParameterSets;", -1, &stmt, nullptr);
+    BOOST_TEST_REQUIRE(sqlite3_step(stmt) == SQLITE_ROW);
+    auto const result = sqlite3_column_int64(stmt, 0);
+    sqlite3_finalize(stmt);
+    return result;
+  };
+
+  // The table is created by the first export, whatever the mode.
+  ParameterSetRegistry::exportTo(
+    db, ParameterSetRegistry::export_mode::incremental);
+  auto const initial_count = count();
+  BOOST_TEST(initial_count > 0);
+
+  // Rows removed by someone else are not written again as long as the
+  // table's largest rowid is unchanged...
+  sqlite3_exec(db,
+               "DELETE FROM ParameterSets WHERE rowid = 1;",
+               nullptr,
+               nullptr,
+               nullptr);
+  auto const pset = ParameterSet::make("incremental: { a: 3 }");
+  ParameterSetRegistry::put(pset);
+  ParameterSetRegistry::exportTo(
+    db, ParameterSetRegistry::export_mode::incremental);
+  BOOST_TEST(count() == initial_count + 1);
+
+  sqlite3_stmt* stmt = nullptr;
+  sqlite3_prepare_v2(db,
+                     "SELECT PSetBlob FROM ParameterSets WHERE ID = ?;",
+                     -1,
+                     &stmt,
+                     nullptr);
+  auto const id = pset.id().to_string();
+  sqlite3_bind_text(stmt, 1, id.c_str(), id.size() + 1, SQLITE_STATIC);
+  BOOST_TEST_REQUIRE(sqlite3_step(stmt) == SQLITE_ROW);
+  BOOST_TEST(reinterpret_cast<char const*>(sqlite3_column_text(stmt, 0)) ==
+             pset.to_compact_string());
+  sqlite3_finalize(stmt);
+
+  // ... but all missing rows are once it has been changed.
+  sqlite3_exec(db,
+               "DELETE FROM ParameterSets WHERE rowid = 2;"
+               "INSERT INTO ParameterSets VALUES('x', 'y');",
+               nullptr,
+               nullptr,
+               nullptr);
+  ParameterSetRegistry::exportTo(
+    db, ParameterSetRegistry::export_mode::incremental);
+  BOOST_TEST(count() == initial_count + 3);
+
+  // A full export replaces the table.
+  ParameterSetRegistry::exportTo(db);
+  BOOST_TEST(count() == initial_count + 2);
+  sqlite3_close(db);
+}
+
+BOOST_AUTO_TEST_CASE(BinaryFormat)
+{
+  sqlite3* db = nullptr;
+  BOOST_TEST_REQUIRE(!sqlite3_open(":memory:", &db));
+  auto const binary = ParameterSetRegistry::blob_format::binary;
+  ParameterSetRegistry::exportTo(
+    db, ParameterSetRegistry::export_mode::full, binary);
+
+  sqlite3_stmt* stmt = nullptr;
+  sqlite3_prepare_v2(db,
+                     "SELECT COUNT(*) FROM ParameterSets "
+                     "WHERE typeof(ID) = 'blob' AND length(ID) = 20 "
+                     "AND typeof(PSetBlob) = 'blob';",
+                     -1,
+                     &stmt,
+                     nullptr);
+  BOOST_TEST_REQUIRE(sqlite3_step(stmt) == SQLITE_ROW);
+  auto const n_binary = sqlite3_column_int64(stmt, 0);
+  sqlite3_finalize(stmt);
+  sqlite3_prepare_v2(
+    db, "SELECT COUNT(*) FROM ParameterSets;", -1, &stmt, nullptr);
+  BOOST_TEST_REQUIRE(sqlite3_step(stmt) == SQLITE_ROW);
+  BOOST_TEST(sqlite3_column_int64(stmt, 0) == n_binary);
+  BOOST_TEST(n_binary >= static_cast<long>(ParameterSetRegistry::size()));
+  sqlite3_finalize(stmt);
+
+  // Binary rows are recognized on import, next to text ones.
+  auto const pset = ParameterSet::make("binary_format: 17 nested: { a: 1 }");
+  BOOST_TEST_REQUIRE(!ParameterSetRegistry::has(pset.id()));
+  sqlite3_prepare_v2(db,
+                     "INSERT INTO ParameterSets(ID, PSetBlob) VALUES(?, ?);",
+                     -1,
+                     &stmt,
+                     nullptr);
+  auto const& digest = pset.id().digest();
+  auto const blob = detail::binary_blob::encode(pset);
+  sqlite3_bind_blob(stmt, 1, digest.data(), digest.size(), SQLITE_STATIC);
+  sqlite3_bind_blob(stmt, 2, blob.data(), blob.size(), SQLITE_STATIC);
+  BOOST_TEST_REQUIRE(sqlite3_step(stmt) == SQLITE_DONE);
+  sqlite3_finalize(stmt);
+  ParameterSetRegistry::importFrom(db);
+  BOOST_TEST(ParameterSetRegistry::get(pset.id()) == pset);
+  sqlite3_close(db);
+}
+
+BOOST_AUTO_TEST_CASE(MappedFile)
+{
+  auto const nested = ParameterSet::make("mapped_nested: { c: 8 }");
+  ParameterSetRegistry::put(nested);
+  ParameterSetRegistry::exportToFile("ParameterSetRegistry_t_1.reg");
+  {
+    detail::mapped_registry_file const file{"ParameterSetRegistry_t_1.reg"};
+    BOOST_TEST(file.size() >= ParameterSetRegistry::size());
+    auto const blob = file.find(nested.id());
+    BOOST_TEST_REQUIRE(blob.has_value());
+    BOOST_TEST(detail::binary_blob::decode(*blob) == nested);
+    BOOST_TEST(!file.find(ParameterSet::make("unregistered: 1").id()));
+  }
+
+  // Only the table that is looked up is materialized.
+  auto const pset =
+    ParameterSet::make("mapped_top: 6 mapped: { leaf: 5 } nested: {}");
+  BOOST_TEST_REQUIRE(!ParameterSetRegistry::has(pset.id()));
+  detail::mapped_registry_file::write(
+    "ParameterSetRegistry_t_2.reg",
+    {{pset.id(), detail::binary_blob::encode(pset)}});
+  ParameterSetRegistry::mapFile("ParameterSetRegistry_t_2.reg");
+  BOOST_TEST(!ParameterSetRegistry::has(pset.id()));
+  auto const initial_size = ParameterSetRegistry::size();
+  BOOST_TEST(ParameterSetRegistry::get(pset.id()) == pset);
+  BOOST_TEST(ParameterSetRegistry::size() == initial_size + 1);
+
+  // Exports include the entries of mapped files.
+  sqlite3* db = nullptr;
+  BOOST_TEST_REQUIRE(!sqlite3_open(":memory:", &db));
+  ParameterSetRegistry::exportTo(db);
+  sqlite3_stmt* stmt = nullptr;
+  sqlite3_prepare_v2(
+    db, "SELECT 1 FROM ParameterSets WHERE ID = ?;", -1, &stmt, nullptr);
+  auto const id = pset.id().to_string();
+  sqlite3_bind_text(stmt, 1, id.c_str(), id.size() + 1, SQLITE_STATIC);
+  BOOST_TEST(sqlite3_step(stmt) == SQLITE_ROW);
+  sqlite3_finalize(stmt);
+  sqlite3_close(db);
+
+  auto const is = [](error const code) {
+    return [code](fhicl::exception const& e) {
+      return e.categoryCode() == code;
+    };
+  };
+  BOOST_CHECK_EXCEPTION(ParameterSetRegistry::mapFile("no_such_file.reg"),
+                        fhicl::exception,
+                        is(error::cant_open_db));
+  auto* garbage = std::fopen("ParameterSetRegistry_t_3.reg", "w");
+  std::fputs("Not a registry file, but long enough to have a header.", garbage);
+  std::fclose(garbage);
+  BOOST_CHECK_EXCEPTION(
+    ParameterSetRegistry::mapFile("ParameterSetRegistry_t_3.reg"),
+    fhicl::exception,
+    is(error::parse_error));
+  std::remove("ParameterSetRegistry_t_3.reg");
+  std::remove("ParameterSetRegistry_t_2.reg");
+  std::remove("ParameterSetRegistry_t_1.reg");
+}
+
+BOOST_AUTO_TEST_CASE(Eviction)
+{
+  auto const initial_size = ParameterSetRegistry::size();
+  ParameterSetRegistry::set_capacity(initial_size + 16);
+  BOOST_TEST(ParameterSetRegistry::capacity() == initial_size + 16);
+
+  auto const held = ParameterSet::make("evict_held: 1");
+  ParameterSetRegistry::put(held);
+  auto const handle = ParameterSetRegistry::acquire(held.id());
+  vector<ParameterSet> psets;
+  for (int i = 0; i != 64; ++i) {
+    auto const n = to_string(i);
+    psets.push_back(
+      ParameterSet::make("evict_" + n + ": { value: " + n + " }"));
+    ParameterSetRegistry::put(psets.back());
+  }
+  BOOST_TEST(ParameterSetRegistry::size() <= initial_size + 16);
+  BOOST_TEST(!ParameterSetRegistry::has(psets.front().id()));
+  BOOST_TEST(ParameterSetRegistry::has(held.id()));
+  BOOST_TEST(*handle == held);
+
+  // Evicted entries are staged again when looked up.
+  for (int i = 0; i != 64; ++i) {
+    ParameterSet found;
+    BOOST_TEST_REQUIRE(ParameterSetRegistry::get(psets[i].id(), found));
+    BOOST_TEST(found == psets[i]);
+    BOOST_TEST(found.get<int>("evict_" + to_string(i) + ".value") == i);
+  }
+  BOOST_TEST(ParameterSetRegistry::size() <= initial_size + 16);
+
+  // References returned by 'get' remain valid until the scope ends.
+  {
+    ParameterSetRegistry::pin_scope const scope;
+    auto const& first = ParameterSetRegistry::get(psets.front().id());
+    for (auto const& ps : psets) {
+      BOOST_TEST(ParameterSetRegistry::acquire(ps.id())->id() == ps.id());
+    }
+    BOOST_TEST(ParameterSetRegistry::has(psets.front().id()));
+    BOOST_TEST(first == psets.front());
+  }
+  ParameterSetRegistry::set_capacity(0);
+}
+
+BOOST_AUTO_TEST_CASE(TransientLookups)
+{
+  // Looking up nested keys pins the tables only while the views exist.
+  auto const initial_size = ParameterSetRegistry::size();
+  ParameterSetRegistry::set_capacity(initial_size + 100);
+  auto const held = ParameterSet::make("m: { a: { x: -1 y: [1, 2] } }");
+  ParameterSetRegistry::put(held);
+  auto const view = held.lookup("m.a");
+  for (int i = 0; i != 1000; ++i) {
+    auto const ps =
+      ParameterSet::make("m: { a: { x: " + to_string(i) + " } } n: 1");
+    ParameterSetRegistry::put(ps);
+    BOOST_TEST(ps.has_key("m.a.x"));
+    BOOST_TEST(ps.is_key_to_table("m.a"));
+    BOOST_TEST(ps.lookup("m")["a.x"].as<int>() == i);
+    for (auto const& [key, value] : ps.lookup("m.a").members()) {
+      BOOST_TEST(key == "x");
+      BOOST_TEST(value.as<int>() == i);
+    }
+  }
+  BOOST_TEST(ParameterSetRegistry::size() <= initial_size + 100);
+
+  BOOST_TEST(ParameterSetRegistry::has(view.table().id()));
+  BOOST_TEST(view["x"].as<int>() == -1);
+  BOOST_TEST(view["y"][1].as<int>() == 2);
+  ParameterSetRegistry::set_capacity(0);
+}
+
+BOOST_AUTO_TEST_CASE(UnscopedLookups)
+{
+  // References returned by 'get' outside a pin_scope do not keep their
+  // entries once the registry has evicted since.
+  auto const initial_size = ParameterSetRegistry::size();
+  ParameterSetRegistry::set_capacity(initial_size + 16);
+  vector<ParameterSetID> ids;
+  for (int i = 0; i != 64; ++i) {
+    auto const ps = ParameterSet::make("unscoped: " + to_string(i));
+    ids.push_back(ParameterSetRegistry::put(ps));
+  }
+  for (auto const& id : ids) {
+    BOOST_TEST(ParameterSetRegistry::get(id).id() == id);
+  }
+  for (int i = 0; i != 64; ++i) {
+    ParameterSetRegistry::put(
+      ParameterSet::make("unscoped_more: " + to_string(i)));
+  }
+  BOOST_TEST(ParameterSetRegistry::size() <= initial_size + 16);
+  ParameterSetRegistry::set_capacity(0);
+}
+
+BOOST_AUTO_TEST_CASE(BatchedHandles)
+{
+  // References to tables already registered when they are put in a
+  // batch remain valid once the batch is published.
+  auto const registered = ParameterSet::make("batched_ref: 1");
+  ParameterSetRegistry::put(registered);
+  ParameterSet const* ref{nullptr};
+  {
+    ParameterSetRegistry::batch outer;
+    auto const ps = ParameterSet::make("outer: { batched_ref: 1 }");
+    BOOST_TEST(ps.get<ParameterSet>("outer").id() == registered.id());
+    ref = &ParameterSetRegistry::get(registered.id());
+    outer.publish();
+  }
+  BOOST_TEST(ref->get<int>("batched_ref") == 1);
+
+  // ... and so do handles to buffered entries that another thread
+  // registers before they are published.
+  {
+    auto const raced = ParameterSet::make("batched_race: 1");
+    ParameterSetRegistry::batch outer;
+    ParameterSetRegistry::put(raced);
+    auto const h = ParameterSetRegistry::acquire(raced.id());
+    std::thread{[&raced] { ParameterSetRegistry::put(raced); }}.join();
+    outer.publish();
+    BOOST_TEST(h->get<int>("batched_race") == 1);
+    BOOST_TEST(&*h != &ParameterSetRegistry::get(raced.id()));
+  }
+
+  // Handles to buffered entries still pin them once published.
+  auto const initial_size = ParameterSetRegistry::size();
+  ParameterSetRegistry::set_capacity(initial_size + 16);
+  ParameterSetRegistry::handle handle;
+  auto const buffered = ParameterSet::make("batched_handle: 1");
+  {
+    ParameterSetRegistry::batch outer;
+    ParameterSetRegistry::put(buffered);
+    handle = ParameterSetRegistry::acquire(buffered.id());
+    outer.publish();
+  }
+  for (int i = 0; i != 64; ++i) {
+    ParameterSetRegistry::put(
+      ParameterSet::make("batched_evict: " + to_string(i)));
+  }
+  BOOST_TEST(ParameterSetRegistry::size() <= initial_size + 16);
+  BOOST_TEST(ParameterSetRegistry::has(buffered.id()));
+  BOOST_TEST(handle->get<int>("batched_handle") == 1);
+  ParameterSetRegistry::set_capacity(0);
+}
+
+BOOST_AUTO_TEST_CASE(GarbageCollection)
+{
+  // With no roots, nothing is collected.
+  BOOST_TEST(ParameterSetRegistry::collect_garbage() == 0u);
+
+  auto const kept =
+    ParameterSet::make("gc_kept: { a: { b: 1 } } gc_seq: [{ c: 2 }]");
+  ParameterSetRegistry::put(kept);
+  auto const dropped = ParameterSet::make("gc_dropped: { d: 3 }");
+  ParameterSetRegistry::put(dropped);
+  auto const dropped_table = dropped.get<ParameterSet>("gc_dropped").id();
+  auto const anchored = ParameterSet::make("gc_anchored: { e: 4 }");
+  ParameterSetRegistry::put(anchored);
+  std::optional<ParameterSetRegistry::anchor> anchor{anchored.id()};
+
+  ParameterSetRegistry::add_root(kept.id());
+  BOOST_TEST(ParameterSetRegistry::collect_garbage() > 0u);
+  std::vector const kept_ids{kept.id(),
+                             kept.get<ParameterSet>("gc_kept").id(),
+                             kept.get<ParameterSet>("gc_kept.a").id(),
+                             kept.get<ParameterSet>("gc_seq[0]").id(),
+                             anchored.id(),
+                             anchored.get<ParameterSet>("gc_anchored").id()};
+  for (auto const& id : kept_ids) {
+    BOOST_TEST(ParameterSetRegistry::has(id));
+  }
+  BOOST_TEST(!ParameterSetRegistry::has(dropped.id()));
+  BOOST_TEST(!ParameterSetRegistry::has(dropped_table));
+
+  // Dropped entries are neither staged again nor exported.
+  ParameterSet ps;
+  BOOST_TEST(!ParameterSetRegistry::get(dropped_table, ps));
+  sqlite3* db = nullptr;
+  BOOST_TEST_REQUIRE(!sqlite3_open(":memory:", &db));
+  ParameterSetRegistry::exportTo(db);
+  sqlite3_stmt* stmt = nullptr;
+  sqlite3_prepare_v2(db,
+                     "SELECT count(*) FROM ParameterSets WHERE ID = ?;",
+                     -1,
+                     &stmt,
+                     nullptr);
+  auto const exported = [stmt](ParameterSetID const& id) {
+    auto const idString = id.to_string();
+    sqlite3_bind_text(
+      stmt, 1, idString.c_str(), idString.size() + 1, SQLITE_TRANSIENT);
+    BOOST_TEST_REQUIRE(sqlite3_step(stmt) == SQLITE_ROW);
+    auto const result = sqlite3_column_int64(stmt, 0) != 0;
+    sqlite3_reset(stmt);
+    return result;
+  };
+  for (auto const& id : kept_ids) {
+    BOOST_TEST(exported(id));
+  }
+  BOOST_TEST(!exported(dropped.id()));
+  BOOST_TEST(!exported(dropped_table));
+  sqlite3_finalize(stmt);
+  sqlite3_close(db);
+
+  // Once its anchor is gone, an entry is collected.
+  anchor.reset();
+  ParameterSetRegistry::collect_garbage();
+  BOOST_TEST(!ParameterSetRegistry::has(anchored.id()));
+
+  // Roots are counted.
+  ParameterSetRegistry::add_root(kept.id());
+  ParameterSetRegistry::remove_root(kept.id());
+  ParameterSetRegistry::put(dropped);
+  ParameterSetRegistry::collect_garbage();
+  BOOST_TEST(ParameterSetRegistry::has(kept.id()));
+  BOOST_TEST(!ParameterSetRegistry::has(dropped.id()));
+  ParameterSetRegistry::remove_root(kept.id());
+}
+
+BOOST_AUTO_TEST_CASE(Statistics)
+{
+  ParameterSetRegistry::reset_stats();
+  auto const pset = ParameterSet::make("stats: { a: 1 }");
+  ParameterSetRegistry::put(pset);
+  ParameterSetRegistry::put(pset);
+  BOOST_TEST(ParameterSetRegistry::get(pset.id()) == pset);
+  ParameterSet ps;
+  BOOST_TEST(!ParameterSetRegistry::get(
+    ParameterSet::make("stats_unregistered: 1").id(), ps));
+  sqlite3* db = nullptr;
+  BOOST_TEST_REQUIRE(!sqlite3_open(":memory:", &db));
+  ParameterSetRegistry::exportTo(db);
+  ParameterSetRegistry::importFrom(db);
+  sqlite3_close(db);
+
+  auto stats = ParameterSetRegistry::stats();
+  if (stats.enabled) {
+    BOOST_TEST(stats.new_puts == 2u);
+    BOOST_TEST(stats.duplicate_puts == 1u);
+    BOOST_TEST(stats.lookups >= 2u); // Exporting looks up nested tables.
+    BOOST_TEST(stats.db_lookups.count == 1u);
+    std::uint64_t in_histogram{};
+    for (auto const n : stats.db_lookups.histogram) {
+      in_histogram += n;
+    }
+    BOOST_TEST(in_histogram == 1u);
+    BOOST_TEST(stats.lock_waits.count >= 3u);
+    BOOST_TEST(stats.export_to.calls == 1u);
+    BOOST_TEST(stats.export_to.rows == ParameterSetRegistry::size());
+    BOOST_TEST(stats.import_from.calls == 1u);
+    BOOST_TEST(stats.import_from.rows == 0u);
+    BOOST_TEST(stats.stage_in.calls == 0u);
+    ParameterSetRegistry::reset_stats();
+    stats = ParameterSetRegistry::stats();
+  }
+  BOOST_TEST(stats.new_puts == 0u);
+  BOOST_TEST(stats.lookups == 0u);
+  BOOST_TEST(stats.db_lookups.count == 0u);
+  BOOST_TEST(stats.lock_waits.count == 0u);
+  BOOST_TEST(stats.export_to.calls == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelStageIn)
+{
+  // Enough rows, in both formats, to be decoded by several tasks.
+  vector<ParameterSet> psets;
+  sqlite3* db = nullptr;
+  BOOST_TEST_REQUIRE(!sqlite3_open(":memory:", &db));
+  char* errMsg = nullptr;
+  sqlite3_exec(db,
+               "CREATE TABLE ParameterSets(ID PRIMARY KEY, PSetBlob);",
+               nullptr,
+               nullptr,
+               &errMsg);
+  throwOnSQLiteFailure(db, errMsg);
+  sqlite3_stmt* stmt = nullptr;
+  sqlite3_prepare_v2(db,
+                     "INSERT INTO ParameterSets(ID, PSetBlob) VALUES(?, ?);",
+                     -1,
+                     &stmt,
+                     nullptr);
+  for (int i = 0; i != 1000; ++i) {
+    auto const n = to_string(i);
+    psets.push_back(ParameterSet::make("parallel_stage_in: " + n +
+                                       " inlined: { v: " + n + " }"));
+    auto const& ps = psets.back();
+    if (i % 2 == 0) {
+      auto const id = ps.id().to_string();
+      auto const blob = ps.to_compact_string();
+      sqlite3_bind_text(stmt, 1, id.c_str(), id.size() + 1, SQLITE_TRANSIENT);
+      sqlite3_bind_text(
+        stmt, 2, blob.c_str(), blob.size() + 1, SQLITE_TRANSIENT);
+    } else {
+      auto const& digest = ps.id().digest();
+      auto const blob = detail::binary_blob::encode(ps);
+      sqlite3_bind_blob(
+        stmt, 1, digest.data(), digest.size(), SQLITE_TRANSIENT);
+      sqlite3_bind_blob(stmt, 2, blob.data(), blob.size(), SQLITE_TRANSIENT);
+    }
+    BOOST_TEST_REQUIRE(sqlite3_step(stmt) == SQLITE_DONE);
+    sqlite3_reset(stmt);
+  }
+  sqlite3_finalize(stmt);
+  ParameterSetRegistry::importFrom(db);
+  sqlite3_close(db);
+
+  for (auto const& ps : psets) {
+    BOOST_TEST_REQUIRE(!ParameterSetRegistry::has(ps.id()));
+  }
+  ParameterSetRegistry::stageIn();
+  for (auto const& ps : psets) {
+    BOOST_TEST_REQUIRE(ParameterSetRegistry::has(ps.id()));
+    BOOST_TEST(ParameterSetRegistry::get(ps.id()) == ps);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(StageSubtree)
+{
+  // The registry trusts the IDs stored in the DB, so made-up IDs can
+  // be used for tables that have never been registered.  (This test
+  // must come last, as the registry's entries then no longer match
+  // their IDs.)
+  auto const fake_id = [](char const c) {
+    return ParameterSetID{string(ParameterSetID::max_str_size() - 1, '0') + c};
+  };
+  auto const leaf = fake_id('1');
+  auto const leaf2 = fake_id('2');
+  auto const mid = fake_id('3');
+  auto const top = fake_id('4');
+  vector<pair<ParameterSetID, string>> const rows{
+    {leaf, "staged_leaf:1"},
+    {leaf2, "staged_leaf:2"},
+    {mid, "staged_mid:3 leaf:@id::" + leaf.to_string()},
+    {top,
+     "staged_top:4 mid:@id::" + mid.to_string() + " seq:[5,[@id::" +
+       leaf2.to_string() + "]]"}};
+  auto const initial_size = ParameterSetRegistry::size();
+
+  sqlite3* db = nullptr;
+  BOOST_TEST_REQUIRE(!sqlite3_open(":memory:", &db));
+  char* errMsg = nullptr;
+  sqlite3_exec(db,
+               "CREATE TABLE ParameterSets(ID PRIMARY KEY, PSetBlob);",
+               nullptr,
+               nullptr,
+               &errMsg);
+  throwOnSQLiteFailure(db, errMsg);
+  for (auto const& [id, blob] : rows) {
+    auto const sql = "INSERT INTO ParameterSets(ID, PSetBlob) VALUES('"s +
+                     id.to_string() + "', '" + blob + "');";
+    sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg);
+    throwOnSQLiteFailure(db, errMsg);
+  }
+  ParameterSetRegistry::importFrom(db);
+  sqlite3_close(db);
+
+  BOOST_TEST(ParameterSetRegistry::size() == initial_size);
+  BOOST_TEST(!ParameterSetRegistry::has(mid));
+
+  // Looking up the top-level table stages all of its descendants.
+  auto const& ps = ParameterSetRegistry::get(top);
+  BOOST_TEST(ParameterSetRegistry::size() == initial_size + 4);
+  for (auto const& id : {leaf, leaf2, mid}) {
+    BOOST_TEST(ParameterSetRegistry::has(id));
+  }
+  BOOST_TEST(ps.get<int>("staged_top") == 4);
+  BOOST_TEST(ps.get<int>("mid.leaf.staged_leaf") == 1);
+  BOOST_TEST(ps.get<int>("seq[1][0].staged_leaf") == 2);
+
+  // Descendants are registered before the tables that contain them.
+  vector<ParameterSetID> ids;
+  for (auto const& entry : ParameterSetRegistry::take_snapshot()) {
+    ids.push_back(entry.first);
+  }
+  auto const position = [&ids](ParameterSetID const& id) {
+    return cet::find_in_all(ids, id) - ids.cbegin();
+  };
+  BOOST_TEST(position(leaf) < position(mid));
+  BOOST_TEST(position(mid) < position(top));
+  BOOST_TEST(position(leaf2) < position(top));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
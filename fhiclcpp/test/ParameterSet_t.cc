@@ -2,6 +2,8 @@
 
 #include "boost/test/unit_test.hpp"
 #include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/intermediate_table.h"
+#include "fhiclcpp/parse.h"
 #include "fhiclcpp/test/boost_test_print_pset.h"
 
 #include <cstddef>
@@ -25,6 +27,15 @@ SampleConfigFixture::SampleConfigFixture()
 
 BOOST_FIXTURE_TEST_SUITE(sampleConfig, SampleConfigFixture)
 
+BOOST_AUTO_TEST_CASE(ParallelMake)
+{
+  cet::filepath_lookup policy("FHICL_FILE_PATH");
+  auto const parallel = ParameterSet::make_parallel("Sample.cfg", policy);
+  BOOST_TEST(parallel.id() == pset.id());
+  BOOST_TEST(parallel.to_indented_string(0, detail::print_mode::annotated) ==
+             pset.to_indented_string(0, detail::print_mode::annotated));
+}
+
 BOOST_AUTO_TEST_CASE(Local)
 {
   fhicl::ParameterSet j;
@@ -339,3 +350,230 @@ BOOST_AUTO_TEST_CASE(Custom)
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(parallel_make)
+
+BOOST_AUTO_TEST_CASE(matches_serial_make)
+{
+  std::string config{"BEGIN_PROLOG p: { q: 1 } END_PROLOG\n"
+                     "s: [1, [2, {a: 3}], {b: @local::p}]\n"};
+  for (int i = 0; i != 100; ++i) {
+    auto const n = std::to_string(i);
+    config += "m" + n + ": { type: T" + n + " v: [" + n + ", " + n +
+              "] t: { x: " + n + " u: { y: [ {z: " + n + "} ] } } }\n";
+  }
+  auto const tbl = parse_document(config);
+  auto const serial = ParameterSet::make(tbl);
+  auto const parallel = ParameterSet::make_parallel(tbl);
+  BOOST_TEST(parallel.id() == serial.id());
+  BOOST_TEST(parallel.get_all_keys() == serial.get_all_keys(),
+             boost::test_tools::per_element());
+  BOOST_TEST(!parallel.has_key("p"));
+  BOOST_TEST(parallel.get<int>("s[2].b.q") == 1);
+  for (auto const& key : serial.get_all_keys()) {
+    BOOST_TEST(parallel.get_src_info(key) == serial.get_src_info(key), key);
+  }
+  BOOST_TEST(ParameterSet::make_parallel(intermediate_table{}).is_empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(overlay)
+
+BOOST_AUTO_TEST_CASE(deep_merge)
+{
+  auto const base = ParameterSet::make(
+    "a: 1 s: [1, 2] t: { x: 1 y: { z: 2 w: 3 } } u: { k: v } v: 5");
+  auto const overrides =
+    ParameterSet::make("a: 2 s: [3] t: { y: { z: 4 } n: new } v: { p: 1 }");
+  auto const merged = ParameterSet::overlay(base, overrides);
+
+  auto const expected = ParameterSet::make(
+    "a: 2 s: [3] t: { x: 1 y: { z: 4 w: 3 } n: new } u: { k: v } v: { p: 1 }");
+  BOOST_TEST(merged == expected);
+  BOOST_TEST(merged.id() == expected.id());
+
+  // Untouched subtables are shared by ID.
+  BOOST_TEST(merged.get<ParameterSet>("u").id() ==
+             base.get<ParameterSet>("u").id());
+  BOOST_TEST(merged.get<ParameterSet>("v").id() ==
+             overrides.get<ParameterSet>("v").id());
+
+  // The inputs are unchanged.
+  BOOST_TEST(base.get<int>("t.y.z") == 2);
+  BOOST_TEST(overrides.get<int>("t.y.z") == 4);
+}
+
+BOOST_AUTO_TEST_CASE(trivial_overlays)
+{
+  auto const base = ParameterSet::make("a: 1 t: { x: 1 y: { z: 2 } }");
+  BOOST_TEST(ParameterSet::overlay(base, ParameterSet{}) == base);
+  BOOST_TEST(ParameterSet::overlay(ParameterSet{}, base) == base);
+  BOOST_TEST(ParameterSet::overlay(base, base) == base);
+  BOOST_TEST(ParameterSet::overlay(
+               base, ParameterSet::make("t: { y: { z: 2 } }")) == base);
+}
+
+BOOST_AUTO_TEST_CASE(source_information)
+{
+  auto const base = ParameterSet::make("a: 1\nb: [1, 2]\nc: 3");
+  auto const overrides = ParameterSet::make("\n\nb: [4]\nc: 3");
+  auto const merged = ParameterSet::overlay(base, overrides);
+  BOOST_TEST(merged.get_src_info("a") == base.get_src_info("a"));
+  BOOST_TEST(merged.get_src_info("b") == overrides.get_src_info("b"));
+  BOOST_TEST(merged.get_src_info("b[0]") == overrides.get_src_info("b[0]"));
+  BOOST_TEST(merged.get_src_info("b[1]").empty());
+  BOOST_TEST(merged.get_src_info("c") == overrides.get_src_info("c"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(nested_put)
+
+BOOST_AUTO_TEST_CASE(put_through_tables)
+{
+  auto pset = ParameterSet::make("a: { b: { c: 1 } d: { e: 2 } } f: 3");
+  auto const sibling_id = pset.get<ParameterSet>("a.d").id();
+  pset.put("a.b.x", 4);
+  BOOST_TEST(pset.get<int>("a.b.x") == 4);
+  BOOST_TEST(pset.get<int>("a.b.c") == 1);
+  BOOST_TEST(pset.get<ParameterSet>("a.d").id() == sibling_id);
+  BOOST_TEST(pset == ParameterSet::make(
+                       "a: { b: { c: 1 x: 4 } d: { e: 2 } } f: 3"));
+
+  // Missing tables along the path are created.
+  pset.put("g.h.i", 5);
+  BOOST_TEST(pset.get<int>("g.h.i") == 5);
+  BOOST_TEST(pset.is_key_to_table("g.h"));
+
+  BOOST_CHECK_EXCEPTION(
+    pset.put("a.b.c", 6), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == fhicl::error::cant_insert;
+    });
+  BOOST_CHECK_EXCEPTION(
+    pset.put("f.x", 6), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == fhicl::error::cant_insert;
+    });
+  BOOST_TEST(pset.get<int>("a.b.c") == 1);
+}
+
+BOOST_AUTO_TEST_CASE(put_or_replace_through_sequences)
+{
+  auto pset =
+    ParameterSet::make("a: { b: [{ c: 1 }, { c: 2 }, { c: 3 }] d: { e: 2 } }");
+  auto const original = pset;
+  auto const element_id = pset.get<ParameterSet>("a.b[0]").id();
+  auto const sibling_id = pset.get<ParameterSet>("a.d").id();
+
+  pset.put_or_replace("a.b[2].c", "x");
+  BOOST_TEST(pset.get<std::string>("a.b[2].c") == "x");
+  BOOST_TEST(pset.get<ParameterSet>("a.b[0]").id() == element_id);
+  BOOST_TEST(pset.get<ParameterSet>("a.d").id() == sibling_id);
+  BOOST_TEST(pset.id() != original.id());
+  BOOST_TEST(
+    pset.id() ==
+    ParameterSet::make("a: { b: [{ c: 1 }, { c: 2 }, { c: x }] d: { e: 2 } }")
+      .id());
+  // The copy is unaffected.
+  BOOST_TEST(original.get<int>("a.b[2].c") == 3);
+
+  pset.put_or_replace_compatible("a.b[1].c", 7);
+  BOOST_TEST(pset.get<int>("a.b[1].c") == 7);
+  BOOST_CHECK_EXCEPTION(pset.put_or_replace_compatible("a.b[1].c", pset),
+                        fhicl::exception,
+                        [](auto const& e) {
+                          return e.categoryCode() == fhicl::error::cant_insert;
+                        });
+
+  BOOST_CHECK_EXCEPTION(
+    pset.put_or_replace("a.b[3].c", 1), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == fhicl::error::cant_insert;
+    });
+  BOOST_CHECK_EXCEPTION(
+    pset.put_or_replace("a.z[0].c", 1), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == fhicl::error::cant_insert;
+    });
+}
+
+BOOST_AUTO_TEST_CASE(source_information)
+{
+  auto pset = ParameterSet::make("a: {\n b: 1\n c: 2\n}");
+  BOOST_TEST(!pset.get<ParameterSet>("a").get_src_info("b").empty());
+  pset.put_or_replace("a.b", 3);
+  BOOST_TEST(pset.get<ParameterSet>("a").get_src_info("b").empty());
+  BOOST_TEST(!pset.get<ParameterSet>("a").get_src_info("c").empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(sequence_modifiers)
+
+BOOST_AUTO_TEST_CASE(append)
+{
+  auto pset = ParameterSet::make("s: [1, 2] t: { u: [] } n: [[1], [2]]");
+  pset.reserve("s", 10);
+  pset.append("s", 3);
+  pset.append("s", "x");
+  pset.append("s", std::vector{4, 5});
+  pset.append("t.u", 6);
+  pset.append("n[1]", 7);
+  BOOST_TEST(pset ==
+             ParameterSet::make(
+               "s: [1, 2, 3, x, [4, 5]] t: { u: [6] } n: [[1], [2, 7]]"));
+  BOOST_TEST(pset.id() ==
+             ParameterSet::make(
+               "s: [1, 2, 3, x, [4, 5]] t: { u: [6] } n: [[1], [2, 7]]")
+               .id());
+
+  BOOST_CHECK_EXCEPTION(
+    pset.append("z", 1), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == fhicl::error::cant_insert;
+    });
+  BOOST_CHECK_EXCEPTION(
+    pset.append("t", 1), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == fhicl::error::cant_insert;
+    });
+  BOOST_CHECK_EXCEPTION(
+    pset.reserve("t", 1), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == fhicl::error::type_mismatch;
+    });
+  BOOST_CHECK_EXCEPTION(
+    pset.reserve("t.v", 1), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == fhicl::error::cant_find;
+    });
+}
+
+BOOST_AUTO_TEST_CASE(set_element)
+{
+  auto pset = ParameterSet::make("s: [1, [2, 3], \"a\"] t: { u: [0, 0] }");
+  auto const copy = pset;
+  pset.set_element("s[0]", 4);
+  pset.set_element("s[1][1]", "y");
+  pset.set_element("s[2]", "b");
+  pset.set_element("t.u[1]", 5);
+  BOOST_TEST(pset.get<int>("s[0]") == 4);
+  BOOST_TEST(pset.get<std::string>("s[1][1]") == "y");
+  BOOST_TEST(pset.get<std::string>("s[2]") == "b");
+  BOOST_TEST(pset.id() ==
+             ParameterSet::make("s: [4, [2, y], b] t: { u: [0, 5] }").id());
+  BOOST_TEST(copy.get<int>("s[0]") == 1);
+  BOOST_TEST(copy.get<std::string>("s[2]") == "a");
+
+  for (auto const key : {"s", "s[3]", "s[0][0]", "t.u[2]", "z[0]"}) {
+    BOOST_CHECK_EXCEPTION(
+      pset.set_element(key, 1), fhicl::exception, [](auto const& e) {
+        return e.categoryCode() == fhicl::error::cant_insert;
+      });
+  }
+}
+
+BOOST_AUTO_TEST_CASE(source_information)
+{
+  auto pset = ParameterSet::make("s: [1,\n 2]");
+  BOOST_TEST(!pset.get_src_info("s[1]").empty());
+  pset.set_element("s[1]", 3);
+  BOOST_TEST(pset.get_src_info("s[1]").empty());
+  BOOST_TEST(!pset.get_src_info("s[0]").empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,211 @@
+#define BOOST_TEST_MODULE (ValueView test)
+#include "boost/test/unit_test.hpp"
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/test/boost_test_print_pset.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace fhicl;
+using namespace std::string_literals;
+
+namespace {
+  auto const config = "a: 7 "
+                      "b: @nil "
+                      "s: [1, 2, [3, 4]] "
+                      "t: { u: hello v: { w: [ {x: 1}, {x: 2} ] } }"s;
+}
+
+BOOST_AUTO_TEST_SUITE(value_view_test)
+
+BOOST_AUTO_TEST_CASE(kinds)
+{
+  auto const pset = ParameterSet::make(config);
+  BOOST_TEST((pset.lookup("a").kind() == value_kind::atom));
+  BOOST_TEST((pset.lookup("b").kind() == value_kind::nil));
+  BOOST_TEST((pset.lookup("s").kind() == value_kind::sequence));
+  BOOST_TEST((pset.lookup("t").kind() == value_kind::table));
+  BOOST_TEST((pset.lookup("t.v.w[1]").kind() == value_kind::table));
+  BOOST_TEST((pset.lookup("z").kind() == value_kind::absent));
+  BOOST_TEST(!pset.lookup("a.b"));
+  BOOST_TEST(!pset.lookup("a[0]"));
+  BOOST_TEST(!pset.lookup("s[3]"));
+  BOOST_TEST(!pset.lookup("t.z.y"));
+}
+
+BOOST_AUTO_TEST_CASE(retrieval)
+{
+  auto const pset = ParameterSet::make(config);
+  BOOST_TEST(pset.lookup("a").as<int>() == 7);
+  BOOST_TEST(pset.lookup("s")[2][1].as<int>() == 4);
+  BOOST_TEST(pset.lookup("s[2][0]").as<int>() == 3);
+  BOOST_TEST(pset.lookup("t")["u"].as<std::string>() == "hello");
+  BOOST_TEST(pset.lookup("t")["v.w[0].x"].as<unsigned>() == 1u);
+  BOOST_TEST(pset.lookup("t.v").table() == pset.get<ParameterSet>("t.v"));
+  BOOST_TEST(pset.lookup("t.v.w[1]").as<ParameterSet>() ==
+             pset.get<ParameterSet>("t.v.w[1]"));
+  BOOST_TEST(ValueView{pset}.as<ParameterSet>() == pset);
+  BOOST_TEST(ValueView{pset}["a"].as<int>() == 7);
+
+  BOOST_CHECK_EXCEPTION(
+    pset.lookup("z").as<int>(), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == cant_find;
+    });
+  BOOST_CHECK_EXCEPTION(
+    pset.lookup("t").as<int>(), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == type_mismatch;
+    });
+  BOOST_CHECK_EXCEPTION(
+    ValueView{pset}.as<int>(), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == type_mismatch;
+    });
+  BOOST_CHECK_EXCEPTION(
+    pset.lookup("a").table(), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == type_mismatch;
+    });
+}
+
+BOOST_AUTO_TEST_CASE(iteration)
+{
+  auto const pset = ParameterSet::make(config);
+
+  auto const s = pset.lookup("s");
+  BOOST_TEST(s.size() == 3ull);
+  std::vector<value_kind> kinds;
+  for (auto const& element : s) {
+    kinds.push_back(element.kind());
+  }
+  BOOST_TEST((kinds == std::vector{value_kind::atom,
+                                   value_kind::atom,
+                                   value_kind::sequence}));
+
+  auto const v = pset.lookup("t.v");
+  BOOST_TEST(v.size() == 1ull);
+  int sum{};
+  for (auto const& w : v) {
+    for (auto const& table : w) {
+      sum += table["x"].as<int>();
+    }
+  }
+  BOOST_TEST(sum == 3);
+
+  auto const a = pset.lookup("a");
+  BOOST_TEST(a.empty());
+  BOOST_TEST((a.begin() == a.end()));
+  auto const z = pset.lookup("z");
+  BOOST_TEST((z.begin() == z.end()));
+}
+
+BOOST_AUTO_TEST_CASE(members)
+{
+  auto const pset = ParameterSet::make(config);
+
+  std::vector<std::string_view> keys;
+  for (auto const& [key, value] : pset) {
+    BOOST_TEST(value.exists());
+    keys.push_back(key);
+  }
+  BOOST_TEST((keys == std::vector<std::string_view>{"a", "b", "s", "t"}));
+  auto const names = pset.get_names();
+  BOOST_TEST((keys == std::vector<std::string_view>(begin(names), end(names))));
+
+  auto keys_of = [](member_range const& r) {
+    std::vector<std::string_view> result;
+    for (auto const& member : r) {
+      result.push_back(member.first);
+    }
+    return result;
+  };
+  BOOST_TEST((keys_of(pset.table_members()) ==
+              std::vector<std::string_view>{"t"}));
+  BOOST_TEST((keys_of(pset.sequence_members()) ==
+              std::vector<std::string_view>{"s"}));
+  BOOST_TEST((keys_of(pset.atom_members()) ==
+              std::vector<std::string_view>{"a", "b"}));
+
+  auto const t = pset.lookup("t");
+  BOOST_TEST((keys_of(t.members()) == std::vector<std::string_view>{"u", "v"}));
+  for (auto const& [key, value] : t.members()) {
+    if (key == "u") {
+      BOOST_TEST(value.as_view() == "hello");
+    } else {
+      BOOST_TEST(value.is_table());
+      BOOST_TEST(value["w"].size() == 2ull);
+    }
+  }
+
+  BOOST_TEST(pset.lookup("a").members().empty());
+  BOOST_TEST(pset.lookup("z").members().empty());
+  BOOST_TEST(ParameterSet{}.members().empty());
+  BOOST_TEST(ParameterSet{}.table_members().empty());
+  BOOST_TEST(ParameterSet::make("a: 1 b: 2").table_members().empty());
+}
+
+BOOST_AUTO_TEST_CASE(key_probes)
+{
+  auto const pset = ParameterSet::make(config);
+  BOOST_TEST(pset.has_key("t.v.w[0].x"));
+  BOOST_TEST(!pset.has_key("t.v.w[2].x"));
+  BOOST_TEST(pset.is_key_to_table("t.v"));
+  BOOST_TEST(pset.is_key_to_sequence("t.v.w"));
+  BOOST_TEST(pset.is_key_to_atom("b"));
+  BOOST_CHECK_EXCEPTION(
+    pset.is_key_to_atom("z"), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == cant_find;
+    });
+}
+
+BOOST_AUTO_TEST_CASE(string_views)
+{
+  auto pset = ParameterSet::make(
+    R"(files: ["a.root", 'b.root'] label: "x\"y" n: 3 b: @nil t: {})");
+  auto const files = pset.lookup("files");
+  std::vector<std::string_view> views;
+  for (auto const& file : files) {
+    views.push_back(file.as_view());
+  }
+  BOOST_TEST((views == std::vector<std::string_view>{"a.root", "b.root"}));
+  BOOST_TEST(pset.get_view("files[1]") == "b.root");
+  BOOST_TEST(pset.get_view("n") == "3");
+
+  // Escaped strings are unescaped once and then served from a cache.
+  auto const label = pset.get_view("label");
+  BOOST_TEST(label == "x\"y");
+  BOOST_TEST(pset.get_view("label").data() == label.data());
+  BOOST_TEST(pset.get<std::string>("label") == label);
+
+  BOOST_CHECK_EXCEPTION(
+    pset.get_view("b"), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == type_mismatch;
+    });
+  BOOST_CHECK_EXCEPTION(
+    pset.get_view("t"), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == type_mismatch;
+    });
+  BOOST_CHECK_EXCEPTION(
+    pset.get_view("z"), fhicl::exception, [](auto const& e) {
+      return e.categoryCode() == cant_find;
+    });
+
+  pset.put_or_replace("label", "plain");
+  BOOST_TEST(pset.get_view("label") == "plain");
+}
+
+BOOST_AUTO_TEST_CASE(string_views_after_reserve)
+{
+  auto pset = ParameterSet::make(R"(s: ["x\"1", "x\"2"])");
+  BOOST_TEST(pset.get_view("s[0]") == "x\"1");
+
+  // Reserving moves the elements, so the cached strings must not be
+  // served for whatever later lives at their old addresses.
+  pset.reserve("s", 64);
+  pset.put("u", "y\"1");
+  pset.append("s", "x\"3");
+  BOOST_TEST(pset.get_view("u") == "y\"1");
+  BOOST_TEST(pset.get_view("s[0]") == "x\"1");
+  BOOST_TEST(pset.get_view("s[2]") == "x\"3");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
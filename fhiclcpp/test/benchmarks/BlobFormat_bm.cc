@@ -0,0 +1,89 @@
+// ======================================================================
+//
+// BlobFormat_bm: Compare the text and binary formats of the
+//                ParameterSets table: the size of a DB holding N*5
+//                ParameterSets, and the time to stage them all in.
+//
+// As the registry is a singleton, the DBs are written, and each of
+// them staged in, by separate child processes.  The DBs are files in
+// the current directory, removed at the end.
+//
+// ======================================================================
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/ParameterSetRegistry.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include "sqlite3.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  using blob_format = ParameterSetRegistry::blob_format;
+
+  char const* const text_db{"BlobFormat_bm_text.db"};
+  char const* const binary_db{"BlobFormat_bm_binary.db"};
+
+  // Each module configuration registers five ParameterSets.
+  std::string
+  configuration(unsigned const n_modules)
+  {
+    std::string result;
+    for (unsigned i = 0; i != n_modules; ++i) {
+      auto const n = std::to_string(i);
+      result += "m" + n + ": { module_type: P" + n +
+                " label: \"module " + n + "\" threshold: 2.5e-3 a: { x: " +
+                n + " b: { y: [1, 2, " + n + "] c: { z: \"" + n +
+                "\" d: { w: [" + n + ", true, @nil] } } } } }\n";
+    }
+    return result;
+  }
+
+  void
+  write_dbs(unsigned const n_modules)
+  {
+    ParameterSetRegistry::put(ParameterSet::make(configuration(n_modules)));
+    std::cout << ParameterSetRegistry::size()
+              << " ParameterSets registered.\n";
+    for (auto const& [filename, format] :
+         {std::pair{text_db, blob_format::text},
+          std::pair{binary_db, blob_format::binary}}) {
+      std::remove(filename);
+      sqlite3* db = nullptr;
+      sqlite3_open(filename, &db);
+      ParameterSetRegistry::exportTo(
+        db, ParameterSetRegistry::export_mode::full, format);
+      sqlite3_close(db);
+    }
+  }
+
+  void
+  stage_in(char const* filename, std::string const& label)
+  {
+    std::cout << label << ": " << std::filesystem::file_size(filename)
+              << " bytes\n";
+    sqlite3* db = nullptr;
+    sqlite3_open(filename, &db);
+    ParameterSetRegistry::importFrom(db);
+    sqlite3_close(db);
+    report(label + ": stageIn",
+           time_per_call(1, [] { ParameterSetRegistry::stageIn(); }));
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const n_modules = iterations(argc, argv, 10000);
+  in_child_process([n_modules] { write_dbs(n_modules); });
+  in_child_process([] { stage_in(text_db, "text"); });
+  in_child_process([] { stage_in(binary_db, "binary"); });
+  std::remove(binary_db);
+  std::remove(text_db);
+}
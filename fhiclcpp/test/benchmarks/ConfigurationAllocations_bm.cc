@@ -0,0 +1,153 @@
+// ======================================================================
+//
+// ConfigurationAllocations_bm: Count the heap allocations made when
+//                              building, freezing and reading a
+//                              configuration, and those made through
+//                              the memory resource given to 'freeze'.
+//
+// ======================================================================
+
+#include "fhiclcpp/FrozenParameterSet.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <sstream>
+#include <string>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  std::size_t global_allocations{};
+
+  class counting_resource : public std::pmr::memory_resource {
+  public:
+    explicit counting_resource(std::pmr::memory_resource* upstream)
+      : upstream_{upstream}
+    {}
+    std::size_t allocations{};
+    std::size_t bytes{};
+
+  private:
+    void*
+    do_allocate(std::size_t const n, std::size_t const alignment) override
+    {
+      ++allocations;
+      bytes += n;
+      return upstream_->allocate(n, alignment);
+    }
+    void
+    do_deallocate(void* p,
+                  std::size_t const n,
+                  std::size_t const alignment) override
+    {
+      upstream_->deallocate(p, n, alignment);
+    }
+    bool
+    do_is_equal(memory_resource const& other) const noexcept override
+    {
+      return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+  };
+
+  std::string
+  job_document(unsigned const n_modules)
+  {
+    std::ostringstream doc;
+    doc << "process_name: BENCH\nphysics: { producers: {\n";
+    for (unsigned i = 0; i != n_modules; ++i) {
+      doc << "  m" << i << ": { module_type: Producer" << i
+          << " threshold: " << 0.5 * i << " labels: [a, b, c, d]";
+      for (unsigned j = 0; j != 20; ++j) {
+        doc << " p" << j << ": " << i * j;
+      }
+      doc << " }\n";
+    }
+    doc << "} }\n";
+    return doc.str();
+  }
+
+  template <typename F>
+  std::size_t
+  global_allocations_in(F&& f)
+  {
+    auto const before = global_allocations;
+    f();
+    return global_allocations - before;
+  }
+
+  void
+  report_count(std::string const& label, std::size_t const n)
+  {
+    std::cout << std::left << std::setw(48) << label << std::right
+              << std::setw(14) << n << '\n';
+  }
+}
+
+void*
+operator new(std::size_t const n)
+{
+  ++global_allocations;
+  if (auto* p = std::malloc(n == 0 ? 1 : n)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void
+operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const n_modules = iterations(argc, argv, 500);
+  auto const doc = job_document(n_modules);
+
+  ParameterSet pset;
+  report_count("global allocations: ParameterSet::make",
+               global_allocations_in([&] { pset = ParameterSet::make(doc); }));
+  report_count("global allocations: ParameterSet::id",
+               global_allocations_in([&] { (void)pset.id(); }));
+
+  std::pmr::monotonic_buffer_resource arena;
+  counting_resource resource{&arena};
+  FrozenParameterSet frozen;
+  report_count(
+    "global allocations: freeze into arena",
+    global_allocations_in([&] { frozen = freeze(pset, &resource); }));
+  report_count("arena allocations: freeze", resource.allocations);
+  report_count("arena bytes: freeze", resource.bytes);
+
+  std::string const key{"physics.producers.m1.p17"};
+  double sum{};
+  report_count("global allocations: 1000 x ParameterSet::get",
+               global_allocations_in([&] {
+                 for (unsigned i = 0; i != 1000; ++i) {
+                   sum += pset.get<double>(key);
+                 }
+               }));
+  report_count("global allocations: 1000 x FrozenParameterSet::get",
+               global_allocations_in([&] {
+                 for (unsigned i = 0; i != 1000; ++i) {
+                   sum += frozen.get<double>(key);
+                 }
+               }));
+  std::cout << '\n' << sum << '\n';
+}
@@ -0,0 +1,72 @@
+// ======================================================================
+//
+// Diff_bm: Compare fhicl::diff with dumping both configurations via
+//          'to_indented_string', the first step of a textual diff.
+//
+// ======================================================================
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/diff.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  ParameterSet
+  module_config(unsigned const i, double const threshold)
+  {
+    ParameterSet result;
+    result.put("module_type", "Producer" + std::to_string(i));
+    result.put("threshold", threshold);
+    result.put("labels", std::vector<std::string>{"a", "b", "c", "d"});
+    for (unsigned j = 0; j != 20; ++j) {
+      result.put("p" + std::to_string(j), i * j);
+    }
+    return result;
+  }
+
+  // Module 'changed' differs in its threshold.
+  ParameterSet
+  job_config(unsigned const n_modules, unsigned const changed)
+  {
+    ParameterSet producers;
+    for (unsigned i = 0; i != n_modules; ++i) {
+      producers.put("m" + std::to_string(i),
+                    module_config(i, i == changed ? -1. : 0.5 * i));
+    }
+    ParameterSet physics;
+    physics.put("producers", producers);
+    ParameterSet result;
+    result.put("process_name", "BENCH");
+    result.put("physics", physics);
+    return result;
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const n = iterations(argc, argv, 100);
+
+  auto const from = job_config(500, 500);
+  auto const to = job_config(500, 7);
+
+  std::size_t total{};
+  report("fhicl::diff",
+         time_per_call(n, [&] { total += diff(from, to).size(); }));
+  report("to_indented_string (both)", time_per_call(n, [&] {
+           total += from.to_indented_string().size() +
+                    to.to_indented_string().size();
+         }));
+
+  for (auto const& d : diff(from, to)) {
+    std::cout << '\n' << d.key << ": " << d.from_value << " -> " << d.to_value;
+  }
+  std::cout << "\n\n" << total << " (checksum)\n";
+}
@@ -0,0 +1,89 @@
+// ======================================================================
+//
+// Eviction_bm: Compare the memory held by a long-running job that reads
+//              N input files, each with its own configuration of 100
+//              modules, with and without a registry capacity.
+//
+// For each file, the job registers the configuration and reads one
+// parameter of each module through a handle.  At the end, it looks up
+// the modules of the first file again, which, with a capacity, have
+// been evicted and are staged from the backing DB.  Reported are the
+// time for the files and the look-ups, the number of entries resident
+// at the end, and the growth of the job's private memory, which
+// includes the backing DB.  As the registry is a singleton, each case
+// is run in a child process.
+//
+// ======================================================================
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/ParameterSetRegistry.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  constexpr unsigned n_modules{100};
+
+  // Each module configuration registers five ParameterSets.
+  std::string
+  configuration(unsigned const file)
+  {
+    std::string result{"file: " + std::to_string(file) + '\n'};
+    for (unsigned i = 0; i != n_modules; ++i) {
+      auto const n = std::to_string(file * n_modules + i);
+      result += "m" + std::to_string(i) + ": { module_type: P" + n +
+                " label: \"module " + n + "\" threshold: 2.5e-3 a: { x: " +
+                n + " b: { y: [1, 2, " + n + "] c: { z: \"" + n +
+                "\" d: { w: [" + n + ", true, @nil] } } } } }\n";
+    }
+    return result;
+  }
+
+  unsigned
+  read_modules(ParameterSetID const& top_id)
+  {
+    auto const top = ParameterSetRegistry::acquire(top_id);
+    unsigned sum{};
+    for (unsigned i = 0; i != n_modules; ++i) {
+      auto const id = top->get<ParameterSetID>("m" + std::to_string(i));
+      sum += ParameterSetRegistry::acquire(id)->get<unsigned>("a.x");
+    }
+    return sum;
+  }
+
+  void
+  job(std::string const& label,
+      unsigned const n_files,
+      ParameterSetRegistry::size_type const capacity)
+  {
+    ParameterSetRegistry::set_capacity(capacity);
+    auto const before = private_memory();
+    std::vector<ParameterSetID> files;
+    unsigned sum{};
+    report(label + ": read files", time_per_call(1, [n_files, &files, &sum] {
+             for (unsigned f = 0; f != n_files; ++f) {
+               auto const config = ParameterSet::make(configuration(f));
+               files.push_back(ParameterSetRegistry::put(config));
+               sum += read_modules(files.back());
+             }
+           }));
+    report(label + ": look up first file again",
+           time_per_call(1, [&files, &sum] { sum += read_modules(files[0]); }));
+    std::cout << "  " << ParameterSetRegistry::size()
+              << " entries resident, private memory: "
+              << private_memory() - before << " kB (sum " << sum << ")\n";
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const n_files = iterations(argc, argv, 200);
+  in_child_process([n_files] { job("unbounded", n_files, 0); });
+  in_child_process([n_files] { job("capacity 5000", n_files, 5000); });
+}
@@ -0,0 +1,81 @@
+// ======================================================================
+//
+// ExportTo_bm: Time exporting a registry of N*5 ParameterSets to
+//              SQLite DBs.
+//
+// The first full export converts every ParameterSet to its blob; a
+// full export to a second DB only copies the blobs.  The incremental
+// export to the first DB follows the registration of 100 more
+// ParameterSets.  The DBs are files in the current directory, removed
+// at the end.
+//
+// ======================================================================
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/ParameterSetRegistry.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include "sqlite3.h"
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  // Each module configuration registers five ParameterSets.
+  std::string
+  configuration(unsigned const first, unsigned const n_modules)
+  {
+    std::string result;
+    for (unsigned i = first; i != first + n_modules; ++i) {
+      auto const n = std::to_string(i);
+      result += "m" + n + ": { module_type: P" + n + " a: { x: " + n +
+                " b: { y: [1, 2, " + n + "] c: { z: " + n + " d: { w: " + n +
+                " } } } } }\n";
+    }
+    return result;
+  }
+
+  sqlite3*
+  open_db(char const* filename)
+  {
+    std::remove(filename);
+    sqlite3* result = nullptr;
+    sqlite3_open(filename, &result);
+    return result;
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const n_modules = iterations(argc, argv, 10000);
+  ParameterSetRegistry::put(ParameterSet::make(configuration(0, n_modules)));
+  std::cout << ParameterSetRegistry::size() << " ParameterSets registered.\n";
+
+  auto* first = open_db("ExportTo_bm_1.db");
+  auto* second = open_db("ExportTo_bm_2.db");
+  report("full export", time_per_call(1, [first] {
+           ParameterSetRegistry::exportTo(first);
+         }));
+  report("full export to another DB", time_per_call(1, [second] {
+           ParameterSetRegistry::exportTo(second);
+         }));
+
+  ParameterSetRegistry::put(ParameterSet::make(configuration(n_modules, 20)));
+  report("incremental export of 100 more", time_per_call(1, [first] {
+           ParameterSetRegistry::exportTo(
+             first, ParameterSetRegistry::export_mode::incremental);
+         }));
+  report("incremental export of none", time_per_call(1, [first] {
+           ParameterSetRegistry::exportTo(
+             first, ParameterSetRegistry::export_mode::incremental);
+         }));
+  sqlite3_close(second);
+  sqlite3_close(first);
+  std::remove("ExportTo_bm_2.db");
+  std::remove("ExportTo_bm_1.db");
+}
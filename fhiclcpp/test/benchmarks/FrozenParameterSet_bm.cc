@@ -0,0 +1,74 @@
+// ======================================================================
+//
+// FrozenParameterSet_bm: Compare nested-key retrieval from a
+//                        ParameterSet and from its frozen copy.
+//
+// ======================================================================
+
+#include "fhiclcpp/FrozenParameterSet.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  ParameterSet
+  job_config(unsigned const n_modules)
+  {
+    ParameterSet producers;
+    for (unsigned i = 0; i != n_modules; ++i) {
+      ParameterSet module;
+      module.put("module_type", "Producer" + std::to_string(i));
+      module.put("threshold", 0.5 * i);
+      module.put("labels", std::vector<std::string>{"a", "b", "c", "d"});
+      for (unsigned j = 0; j != 20; ++j) {
+        module.put("p" + std::to_string(j), i * j);
+      }
+      producers.put("m" + std::to_string(i), module);
+    }
+    ParameterSet physics;
+    physics.put("producers", producers);
+    ParameterSet result;
+    result.put("process_name", "BENCH");
+    result.put("physics", physics);
+    return result;
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const n = iterations(argc, argv, 100000);
+
+  auto const pset = job_config(500);
+  auto const frozen = freeze(pset);
+  std::cout << "Frozen block: " << frozen.size_in_bytes() << " bytes\n";
+
+  std::string const deep_key{"physics.producers.m250.p17"};
+  std::string const label_key{"physics.producers.m250.labels[2]"};
+  double sum{};
+
+  report("ParameterSet::get<double> (nested)",
+         time_per_call(n, [&] { sum += pset.get<double>(deep_key); }));
+  report("FrozenParameterSet::get<double> (nested)",
+         time_per_call(n, [&] { sum += frozen.get<double>(deep_key); }));
+  report("ParameterSet::get<std::string> (sequence)",
+         time_per_call(
+           n, [&] { sum += pset.get<std::string>(label_key).size(); }));
+  report("FrozenParameterSet::get_view (sequence)",
+         time_per_call(n, [&] { sum += frozen.get_view(label_key).size(); }));
+  auto const n_copies = n / 1000 + 1;
+  report("freeze (500 modules)", time_per_call(n_copies, [&] {
+           sum += freeze(pset).size_in_bytes();
+         }));
+  report("thaw (500 modules)", time_per_call(n_copies, [&] {
+           sum += frozen.thaw().is_empty();
+         }));
+
+  std::cout << '\n' << sum << '\n';
+}
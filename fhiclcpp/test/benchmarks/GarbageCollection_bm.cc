@@ -0,0 +1,90 @@
+// ======================================================================
+//
+// GarbageCollection_bm: Measure the entries and exported rows left by
+//                       a job that makes N candidate configurations of
+//                       100 modules and keeps only the last one, with
+//                       and without collecting garbage.
+//
+// Each candidate differs from the previous one in every module, as an
+// overlay or a validation copy would.  Reported are the time to make
+// the candidates, to collect garbage with the kept configuration as the
+// only root, and to export the registry, together with the number of
+// entries and exported rows.  As the registry is a singleton, each case
+// is run in a child process.
+//
+// ======================================================================
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/ParameterSetRegistry.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include "sqlite3.h"
+
+#include <iostream>
+#include <string>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  constexpr unsigned n_modules{100};
+
+  std::string
+  configuration(unsigned const candidate)
+  {
+    std::string result;
+    auto const c = std::to_string(candidate);
+    for (unsigned i = 0; i != n_modules; ++i) {
+      auto const n = std::to_string(i);
+      result += "m" + n + ": { module_type: P" + n + " threshold: " + c +
+                " a: { x: " + n + " b: { y: [1, 2, " + c + "] } } }\n";
+    }
+    return result;
+  }
+
+  long
+  exported_rows()
+  {
+    sqlite3* db = nullptr;
+    sqlite3_open(":memory:", &db);
+    report("  exportTo",
+           time_per_call(1, [db] { ParameterSetRegistry::exportTo(db); }));
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(
+      db, "SELECT count(*) FROM ParameterSets;", -1, &stmt, nullptr);
+    sqlite3_step(stmt);
+    auto const result = sqlite3_column_int64(stmt, 0);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return result;
+  }
+
+  void
+  job(unsigned const n_candidates, bool const collect)
+  {
+    std::cout << (collect ? "with" : "without") << " garbage collection\n";
+    ParameterSetID kept;
+    report("  make candidates", time_per_call(1, [n_candidates, &kept] {
+             for (unsigned c = 0; c != n_candidates; ++c) {
+               kept = ParameterSetRegistry::put(
+                 ParameterSet::make(configuration(c)));
+             }
+           }));
+    if (collect) {
+      ParameterSetRegistry::add_root(kept);
+      report("  collect_garbage",
+             time_per_call(1, [] { ParameterSetRegistry::collect_garbage(); }));
+    }
+    auto const size = ParameterSetRegistry::size();
+    auto const rows = exported_rows();
+    std::cout << "  " << size << " entries, " << rows << " rows exported\n";
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const n_candidates = iterations(argc, argv, 100);
+  in_child_process([n_candidates] { job(n_candidates, false); });
+  in_child_process([n_candidates] { job(n_candidates, true); });
+}
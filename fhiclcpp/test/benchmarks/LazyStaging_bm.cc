@@ -0,0 +1,119 @@
+// ======================================================================
+//
+// LazyStaging_bm: Compare staging every ParameterSet of a large input
+//                 DB (stageIn) with staging on demand only the few
+//                 that a job looks up.
+//
+// The DB holds N module configurations, each with two levels of
+// nested tables.  The lazy case looks up 10 of them and reads a
+// parameter from their innermost tables.  As the registry is a
+// singleton, each case is run once, the lazy one first.
+//
+// ======================================================================
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/ParameterSetRegistry.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include "sqlite3.h"
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  // The registry trusts the IDs stored in the DB, so no ParameterSets
+  // need to be made (and registered) to fill it.
+  ParameterSetID
+  fake_id(unsigned const i)
+  {
+    char buffer[ParameterSetID::max_str_size() + 1];
+    std::snprintf(buffer, sizeof(buffer), "%040x", i);
+    return ParameterSetID{buffer};
+  }
+
+  void
+  insert(sqlite3_stmt* stmt, ParameterSetID const& id, std::string const& blob)
+  {
+    auto const idString = id.to_string();
+    sqlite3_bind_text(
+      stmt, 1, idString.c_str(), idString.size() + 1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, blob.c_str(), blob.size() + 1, SQLITE_TRANSIENT);
+    sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+  }
+
+  // Returns the IDs of the top-level module configurations.
+  std::vector<ParameterSetID>
+  fill(sqlite3* db, unsigned const n_modules)
+  {
+    sqlite3_exec(db,
+                 "CREATE TABLE ParameterSets(ID PRIMARY KEY, PSetBlob);"
+                 "BEGIN;",
+                 nullptr,
+                 nullptr,
+                 nullptr);
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db,
+                       "INSERT INTO ParameterSets(ID, PSetBlob) VALUES(?, ?);",
+                       -1,
+                       &stmt,
+                       nullptr);
+    std::vector<ParameterSetID> result;
+    unsigned next_id{1};
+    for (unsigned i = 0; i != n_modules; ++i) {
+      auto const n = std::to_string(i);
+      auto const inner = fake_id(next_id++);
+      insert(stmt, inner, "depth:2 index:" + n + " values:[1,2,3,4,5,6]");
+      auto const outer = fake_id(next_id++);
+      insert(stmt,
+             outer,
+             "depth:1 label:outer" + n + " inner:@id::" + inner.to_string());
+      std::string blob{"module_type:Producer" + n};
+      for (unsigned j = 0; j != 20; ++j) {
+        blob += " p" + std::to_string(j) + ":" + std::to_string(i * j);
+      }
+      blob += " outer:@id::" + outer.to_string();
+      auto const top = fake_id(next_id++);
+      insert(stmt, top, blob);
+      result.push_back(top);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+    return result;
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const n_modules = iterations(argc, argv, 20000);
+
+  sqlite3* db = nullptr;
+  sqlite3_open(":memory:", &db);
+  auto const ids = fill(db, n_modules);
+
+  report("importFrom",
+         time_per_call(1, [db] { ParameterSetRegistry::importFrom(db); }));
+
+  unsigned sum{};
+  report("lazy: look up 10 modules", time_per_call(1, [&ids, &sum] {
+           for (unsigned i = 0; i != 10; ++i) {
+             auto const& ps = ParameterSetRegistry::get(ids[i * 97]);
+             sum += ps.get<unsigned>("outer.inner.index");
+           }
+         }));
+  auto const after_lazy = ParameterSetRegistry::size();
+  report("eager: stageIn",
+         time_per_call(1, [] { ParameterSetRegistry::stageIn(); }));
+
+  sqlite3_close(db);
+  std::cout << '\n'
+            << after_lazy << " ParameterSets registered after lazy look-ups, "
+            << ParameterSetRegistry::size() << " after stageIn (sum " << sum
+            << ").\n";
+}
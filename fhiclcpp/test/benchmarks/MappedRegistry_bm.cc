@@ -0,0 +1,101 @@
+// ======================================================================
+//
+// MappedRegistry_bm: Compare the start-up of worker processes that
+//                    each parse the same configuration of N modules
+//                    with that of workers mapping a registry file
+//                    written once.
+//
+// Each worker runs in a child process with an empty registry, obtains
+// the top-level ParameterSet, and reads one parameter of 10 modules.
+// Reported are its time and the growth of its private (unshared)
+// memory.  The pages of a mapped file are shared among processes, but
+// count as private while only one process maps them; as the workers
+// run one after the other, the figure for mapping is an upper bound.
+// The files are written to the current directory, and removed at the
+// end.
+//
+// ======================================================================
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/ParameterSetRegistry.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  char const* const registry_file{"MappedRegistry_bm.reg"};
+  char const* const id_file{"MappedRegistry_bm.id"};
+  constexpr unsigned n_workers{4};
+
+  std::string
+  configuration(unsigned const n_modules)
+  {
+    std::string result;
+    for (unsigned i = 0; i != n_modules; ++i) {
+      auto const n = std::to_string(i);
+      result += "m" + n + ": { module_type: P" + n +
+                " label: \"module " + n + "\" threshold: 2.5e-3 a: { x: " +
+                n + " b: { y: [1, 2, " + n + "] c: { z: \"" + n +
+                "\" d: { w: [" + n + ", true, @nil] } } } } }\n";
+    }
+    return result;
+  }
+
+  template <typename F>
+  void
+  worker(std::string const& label, F const& start_up)
+  {
+    auto const before = private_memory();
+    unsigned sum{};
+    auto const us = time_per_call(1, [&start_up, &sum] {
+      auto const top = start_up();
+      for (unsigned i = 0; i != 10; ++i) {
+        sum += top.template get<unsigned>("m" + std::to_string(i * 97) +
+                                          ".a.x");
+      }
+    });
+    report(label, us);
+    std::cout << "  private memory: " << private_memory() - before
+              << " kB (sum " << sum << ")\n";
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const config = configuration(iterations(argc, argv, 10000));
+
+  in_child_process([&config] {
+    auto const top = ParameterSet::make(config);
+    ParameterSetRegistry::put(top);
+    ParameterSetRegistry::exportToFile(registry_file);
+    std::ofstream{id_file} << top.id().to_string();
+    std::cout << ParameterSetRegistry::size()
+              << " ParameterSets written.\n";
+  });
+  std::string id;
+  std::ifstream{id_file} >> id;
+
+  for (unsigned i = 0; i != n_workers; ++i) {
+    in_child_process([&config] {
+      worker("parse the configuration",
+             [&config] { return ParameterSet::make(config); });
+    });
+  }
+  for (unsigned i = 0; i != n_workers; ++i) {
+    in_child_process([&id] {
+      worker("map the registry file", [&id] {
+        ParameterSetRegistry::mapFile(registry_file);
+        return ParameterSetRegistry::get(ParameterSetID{id});
+      });
+    });
+  }
+  std::remove(id_file);
+  std::remove(registry_file);
+}
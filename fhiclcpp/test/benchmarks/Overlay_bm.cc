@@ -0,0 +1,89 @@
+// ======================================================================
+//
+// Overlay_bm: Compare ParameterSet::overlay with the usual
+//             get/copy/put_or_replace/put-back idiom for applying a
+//             few overrides deep inside a large configuration.
+//
+// ======================================================================
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  ParameterSet
+  module_config(unsigned const i)
+  {
+    ParameterSet result;
+    result.put("module_type", "Producer" + std::to_string(i));
+    result.put("threshold", 0.5 * i);
+    result.put("labels", std::vector<std::string>{"a", "b", "c", "d"});
+    for (unsigned j = 0; j != 20; ++j) {
+      result.put("p" + std::to_string(j), i * j);
+    }
+    return result;
+  }
+
+  ParameterSet
+  job_config(unsigned const n_modules)
+  {
+    ParameterSet producers;
+    for (unsigned i = 0; i != n_modules; ++i) {
+      producers.put("m" + std::to_string(i), module_config(i));
+    }
+    ParameterSet physics;
+    physics.put("producers", producers);
+    ParameterSet result;
+    result.put("process_name", "BENCH");
+    result.put("physics", physics);
+    return result;
+  }
+
+  // The manual equivalent of overlaying "physics.producers.m7.threshold"
+  // and "physics.producers.m7.labels".
+  ParameterSet
+  by_hand(ParameterSet const& base)
+  {
+    auto physics = base.get<ParameterSet>("physics");
+    auto producers = physics.get<ParameterSet>("producers");
+    auto m7 = producers.get<ParameterSet>("m7");
+    m7.put_or_replace("threshold", 2.5);
+    m7.put_or_replace("labels", std::vector<std::string>{"x"});
+    producers.put_or_replace("m7", m7);
+    physics.put_or_replace("producers", producers);
+    auto result = base;
+    result.put_or_replace("physics", physics);
+    return result;
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const n = iterations(argc, argv, 100);
+
+  auto const base = job_config(500);
+  auto const overrides = ParameterSet::make(
+    "physics: { producers: { m7: { threshold: 2.5 labels: [x] } } }");
+
+  std::size_t n_keys{};
+  report("get/put_or_replace by hand",
+         time_per_call(n, [&] { n_keys += by_hand(base).get_names().size(); }));
+  report("overlay", time_per_call(n, [&] {
+           n_keys += ParameterSet::overlay(base, overrides).get_names().size();
+         }));
+
+  std::cout << '\n'
+            << std::boolalpha << "Results agree: "
+            << (by_hand(base).id() ==
+                ParameterSet::overlay(base, overrides).id())
+            << '\n'
+            << n_keys << " top-level keys seen.\n";
+}
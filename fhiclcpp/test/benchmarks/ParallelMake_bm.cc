@@ -0,0 +1,68 @@
+// ======================================================================
+//
+// ParallelMake_bm: Compare ParameterSet::make with
+//                  ParameterSet::make_parallel for a configuration
+//                  with many independent module tables, for several
+//                  limits on the number of TBB worker threads.
+//
+// ======================================================================
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/intermediate_table.h"
+#include "fhiclcpp/parse.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+#include "tbb/global_control.h"
+#include "tbb/info.h"
+
+#include <iostream>
+#include <string>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  std::string
+  job_config(unsigned const n_modules)
+  {
+    std::string result{"process_name: BENCH\nphysics: { producers: {\n"};
+    for (unsigned i = 0; i != n_modules; ++i) {
+      auto const n = std::to_string(i);
+      result += "  m" + n + ": { module_type: Producer" + n +
+                " threshold: " + n + ".5 labels: [a, b, c, d]" +
+                " nested: { x: " + n + " y: [ { z: 1 }, { z: 2 } ] }";
+      for (unsigned j = 0; j != 20; ++j) {
+        result += " p" + std::to_string(j) + ": " + std::to_string(i * j);
+      }
+      result += " }\n";
+    }
+    return result + "} }\n";
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const n = iterations(argc, argv, 20);
+
+  auto const tbl = parse_document(job_config(2000));
+  auto const expected = ParameterSet::make(tbl).id();
+
+  std::cout << "Available hardware threads: "
+            << tbb::info::default_concurrency() << "\n\n";
+
+  report("make", time_per_call(n, [&] { (void)ParameterSet::make(tbl); }));
+  for (int const threads : {1, 4, 16}) {
+    tbb::global_control const limit{
+      tbb::global_control::max_allowed_parallelism,
+      static_cast<std::size_t>(threads)};
+    bool same{true};
+    report("make_parallel, " + std::to_string(threads) + " thread(s)",
+           time_per_call(n, [&] {
+             same &= (ParameterSet::make_parallel(tbl).id() == expected);
+           }));
+    if (!same) {
+      std::cout << "Parallel and serial results differ!\n";
+      return 1;
+    }
+  }
+}
@@ -0,0 +1,103 @@
+// ======================================================================
+//
+// ParameterSetEquality_bm: Compare the cost of ParameterSet equality
+//                          for equal and unequal configurations,
+//                          with and without cached IDs.
+//
+// ======================================================================
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  ParameterSet
+  module_config(unsigned const i)
+  {
+    ParameterSet result;
+    result.put("module_type", "Producer" + std::to_string(i));
+    result.put("threshold", 0.5 * i);
+    result.put("labels", std::vector<std::string>{"a", "b", "c", "d"});
+    for (unsigned j = 0; j != 20; ++j) {
+      result.put("p" + std::to_string(j), i * j);
+    }
+    return result;
+  }
+
+  ParameterSet
+  job_config(unsigned const n_modules)
+  {
+    ParameterSet producers;
+    for (unsigned i = 0; i != n_modules; ++i) {
+      producers.put("m" + std::to_string(i), module_config(i));
+    }
+    ParameterSet result;
+    result.put("process_name", "BENCH");
+    result.put("producers", producers);
+    for (unsigned j = 0; j != 100; ++j) {
+      result.put("top" + std::to_string(j), j);
+    }
+    return result;
+  }
+
+  // Replacing and restoring a value invalidates the cached ID
+  // without changing the ParameterSet's contents.
+  void
+  touch(ParameterSet& ps)
+  {
+    ps.put_or_replace("process_name", "TOUCHED");
+    ps.put_or_replace("process_name", "BENCH");
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const n = iterations(argc, argv, 1000);
+
+  auto lhs = job_config(500);
+  auto rhs = job_config(500);
+  auto unequal_first = rhs;
+  unequal_first.put_or_replace("process_name", "OTHER");
+  auto unequal_last = rhs;
+  unequal_last.put_or_replace("top99", -1);
+
+  unsigned n_equal{};
+  auto const reset = [&] {
+    touch(lhs);
+    touch(rhs);
+    touch(unequal_first);
+    touch(unequal_last);
+  };
+
+  report("equal, structural",
+         time_per_call(
+           n, [&] { n_equal += (lhs == rhs); }, reset));
+  report("unequal (first key), structural",
+         time_per_call(
+           n, [&] { n_equal += (lhs == unequal_first); }, reset));
+  report("unequal (last key), structural",
+         time_per_call(
+           n, [&] { n_equal += (lhs == unequal_last); }, reset));
+  report("equal, via freshly computed IDs",
+         time_per_call(
+           n, [&] { n_equal += (lhs.id() == rhs.id()); }, reset));
+  report("unequal, via freshly computed IDs",
+         time_per_call(
+           n, [&] { n_equal += (lhs.id() == unequal_last.id()); }, reset));
+
+  (void)lhs.id();
+  (void)rhs.id();
+  (void)unequal_last.id();
+  report("equal, cached IDs", time_per_call(n, [&] { n_equal += (lhs == rhs); }));
+  report("unequal, cached IDs",
+         time_per_call(n, [&] { n_equal += (lhs == unequal_last); }));
+
+  std::cout << '\n' << n_equal << " comparisons returned true.\n";
+}
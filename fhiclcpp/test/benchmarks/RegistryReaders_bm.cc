@@ -0,0 +1,77 @@
+// ======================================================================
+//
+// RegistryReaders_bm: Throughput of ParameterSetRegistry::get for
+//                     1-64 threads concurrently looking up entries
+//                     that are already in the registry.
+//
+// Each thread looks up every nested table of a large configuration
+// once per round; the reported time is per round.  With perfect
+// scaling, the time per round is independent of the number of
+// threads (up to the number of cores).
+//
+// ======================================================================
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/ParameterSetRegistry.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  std::vector<ParameterSetID>
+  registered_ids(unsigned const n_tables)
+  {
+    std::string config;
+    for (unsigned i = 0; i != n_tables; ++i) {
+      auto const n = std::to_string(i);
+      config +=
+        "t" + n + ": { a: " + n + " b: [1, 2, 3] c: { d: " + n + " } }\n";
+    }
+    auto const pset = ParameterSet::make(config);
+    std::vector<ParameterSetID> result;
+    for (auto const& name : pset.get_names()) {
+      result.push_back(pset.get<ParameterSet>(name).id());
+    }
+    return result;
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const n = iterations(argc, argv, 10);
+  auto const ids = registered_ids(10000);
+
+  std::atomic<std::size_t> n_found{};
+  for (unsigned const n_threads : {1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+    auto const read_all = [&] {
+      std::size_t local{};
+      for (auto const& id : ids) {
+        local += !ParameterSetRegistry::get(id).is_empty();
+      }
+      n_found += local;
+    };
+    report(std::to_string(n_threads) + " reader thread(s)",
+           time_per_call(n, [&] {
+             std::vector<std::thread> threads;
+             for (unsigned i = 0; i != n_threads; ++i) {
+               threads.emplace_back(read_all);
+             }
+             for (auto& thread : threads) {
+               thread.join();
+             }
+           }));
+  }
+
+  std::cout << '\n'
+            << std::thread::hardware_concurrency() << " hardware thread(s), "
+            << n_found << " lookups succeeded.\n";
+}
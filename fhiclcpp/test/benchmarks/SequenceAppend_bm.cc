@@ -0,0 +1,64 @@
+// ======================================================================
+//
+// SequenceAppend_bm: Compare ParameterSet::append with the
+//                    get<std::vector<T>>/push_back/put_or_replace idiom
+//                    for growing a sequence one element at a time.
+//
+// ======================================================================
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  constexpr unsigned n_elements{2000};
+
+  ParameterSet
+  by_hand()
+  {
+    ParameterSet result;
+    result.put("values", std::vector<double>{});
+    for (unsigned i = 0; i != n_elements; ++i) {
+      auto values = result.get<std::vector<double>>("values");
+      values.push_back(0.5 * i);
+      result.put_or_replace("values", values);
+    }
+    return result;
+  }
+
+  ParameterSet
+  appended()
+  {
+    ParameterSet result;
+    result.put("values", std::vector<double>{});
+    result.reserve("values", n_elements);
+    for (unsigned i = 0; i != n_elements; ++i) {
+      result.append("values", 0.5 * i);
+    }
+    return result;
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const n = iterations(argc, argv, 5);
+
+  std::size_t n_keys{};
+  report("get/push_back/put_or_replace",
+         time_per_call(n, [&] { n_keys += by_hand().get_names().size(); }));
+  report("append",
+         time_per_call(n, [&] { n_keys += appended().get_names().size(); }));
+
+  std::cout << '\n'
+            << std::boolalpha
+            << "Results agree: " << (by_hand().id() == appended().id())
+            << '\n'
+            << n_keys << " top-level keys seen.\n";
+}
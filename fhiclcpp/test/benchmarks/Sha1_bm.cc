@@ -0,0 +1,47 @@
+// ======================================================================
+//
+// Sha1_bm: Compare the SHA-1 backends used for ParameterSetIDs, for
+//          message sizes typical of small and large configurations.
+//          The portable backend is cet::sha1.
+//
+// ======================================================================
+
+#include "fhiclcpp/detail/sha1.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+using namespace fhicl::detail;
+using namespace fhiclcpp_benchmarks;
+
+int
+main(int argc, char** argv)
+{
+  auto const n = iterations(argc, argv, 2000);
+
+  std::cout << "Default backend: " << to_string(sha1_default_backend())
+            << "\n\n";
+
+  unsigned checksum{};
+  for (std::size_t const size : {64u, 1024u, 65536u}) {
+    std::string data(size, 'x');
+    for (std::size_t i = 0; i != size; ++i) {
+      data[i] = static_cast<char>('!' + (i * 7) % 90);
+    }
+    auto const suffix = " (" + std::to_string(size) + " bytes)";
+    for (auto const backend : {sha1_backend::portable,
+                               sha1_backend::x86_sha_ni,
+                               sha1_backend::armv8_sha}) {
+      if (!sha1_backend_available(backend)) {
+        continue;
+      }
+      report(to_string(backend) + suffix, time_per_call(n, [&] {
+               checksum += sha1(data, backend)[0];
+             }));
+    }
+    std::cout << '\n';
+  }
+  std::cout << checksum << " (checksum)\n";
+}
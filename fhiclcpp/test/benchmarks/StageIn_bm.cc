@@ -0,0 +1,124 @@
+// ======================================================================
+//
+// StageIn_bm: Time importFrom and stageIn of a synthetic DB holding N
+//             ParameterSets, with the blobs decoded by a single thread
+//             and by as many as TBB allows.
+//
+// Each blob is a module configuration of 20 parameters and a small
+// table that is inlined in its compact string.  As the registry is a
+// singleton, each case is run in a child process, which checks that
+// every ParameterSet was registered.
+//
+// ======================================================================
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/ParameterSetRegistry.h"
+#include "fhiclcpp/test/benchmarks/benchmark_helpers.h"
+
+#include "sqlite3.h"
+#include "tbb/global_control.h"
+#include "tbb/info.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace fhicl;
+using namespace fhiclcpp_benchmarks;
+
+namespace {
+  // The registry trusts the IDs stored in the DB, so no ParameterSets
+  // need to be made (and registered) to fill it.  The IDs are spread
+  // like digests (by SplitMix64), as the registry hashes their leading
+  // bytes.
+  ParameterSetID
+  fake_id(std::uint64_t state)
+  {
+    std::string hex;
+    while (hex.size() < ParameterSetID::max_str_size()) {
+      auto z = (state += 0x9e3779b97f4a7c15);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+      char buffer[17];
+      std::snprintf(buffer,
+                    sizeof(buffer),
+                    "%016llx",
+                    static_cast<unsigned long long>(z ^ (z >> 31)));
+      hex += buffer;
+    }
+    hex.resize(ParameterSetID::max_str_size());
+    return ParameterSetID{hex};
+  }
+
+  std::vector<ParameterSetID>
+  fill(sqlite3* db, unsigned const n)
+  {
+    sqlite3_exec(db,
+                 "CREATE TABLE ParameterSets(ID PRIMARY KEY, PSetBlob);"
+                 "BEGIN;",
+                 nullptr,
+                 nullptr,
+                 nullptr);
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db,
+                       "INSERT INTO ParameterSets(ID, PSetBlob) VALUES(?, ?);",
+                       -1,
+                       &stmt,
+                       nullptr);
+    std::vector<ParameterSetID> result;
+    for (unsigned i = 0; i != n; ++i) {
+      auto const id = fake_id(i);
+      auto const idString = id.to_string();
+      std::string blob{"module_type:Producer" + std::to_string(i)};
+      for (unsigned j = 0; j != 20; ++j) {
+        blob += " p" + std::to_string(j) + ":" + std::to_string(i * j);
+      }
+      blob += " inner:{index:" + std::to_string(i) + "}";
+      sqlite3_bind_text(
+        stmt, 1, idString.c_str(), idString.size() + 1, SQLITE_TRANSIENT);
+      sqlite3_bind_text(
+        stmt, 2, blob.c_str(), blob.size() + 1, SQLITE_TRANSIENT);
+      sqlite3_step(stmt);
+      sqlite3_reset(stmt);
+      result.push_back(id);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+    return result;
+  }
+
+  void
+  stage_in(unsigned const n, int const threads)
+  {
+    tbb::global_control const control{
+      tbb::global_control::max_allowed_parallelism,
+      static_cast<std::size_t>(threads)};
+    sqlite3* db = nullptr;
+    sqlite3_open(":memory:", &db);
+    auto const ids = fill(db, n);
+    auto const label = std::to_string(threads) + " thread(s): ";
+    report(label + "importFrom",
+           time_per_call(1, [db] { ParameterSetRegistry::importFrom(db); }));
+    sqlite3_close(db);
+    report(label + "stageIn",
+           time_per_call(1, [] { ParameterSetRegistry::stageIn(); }));
+    unsigned missing{};
+    for (auto const& id : ids) {
+      missing += !ParameterSetRegistry::has(id);
+    }
+    std::cout << "  " << ParameterSetRegistry::size() << " registered, "
+              << missing << " missing.\n";
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  auto const n = iterations(argc, argv, 100000);
+  in_child_process([n] { stage_in(n, 1); });
+  in_child_process([n] { stage_in(n, tbb::info::default_concurrency()); });
+  std::cout << '\n'
+            << tbb::info::default_concurrency() << " hardware thread(s).\n";
+}
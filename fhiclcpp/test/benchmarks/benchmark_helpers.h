@@ -0,0 +1,105 @@
+#ifndef fhiclcpp_test_benchmarks_benchmark_helpers_h
+#define fhiclcpp_test_benchmarks_benchmark_helpers_h
+
+// ======================================================================
+//
+// Minimal timing support for the fhiclcpp benchmarks.  Each benchmark
+// is a stand-alone executable that is built (but not run) as part of
+// the test suite.  The number of iterations may be overridden by the
+// first command-line argument.
+//
+// Benchmarks of the ParameterSetRegistry, a singleton, run each case
+// in a child process, so that it starts with an empty registry.
+//
+// ======================================================================
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace fhiclcpp_benchmarks {
+
+  inline unsigned
+  iterations(int argc, char** argv, unsigned const default_iterations)
+  {
+    return argc > 1 ? std::strtoul(argv[1], nullptr, 10) : default_iterations;
+  }
+
+  // Returns the mean wall-clock time per call, in microseconds.  The
+  // optional 'setup' callable is invoked before each call and is not
+  // included in the timing.
+  template <typename F, typename Setup>
+  double
+  time_per_call(unsigned const n, F&& f, Setup&& setup)
+  {
+    using clock = std::chrono::steady_clock;
+    clock::duration total{};
+    for (unsigned i = 0; i != n; ++i) {
+      setup();
+      auto const start = clock::now();
+      f();
+      total += clock::now() - start;
+    }
+    return std::chrono::duration<double, std::micro>(total).count() / n;
+  }
+
+  template <typename F>
+  double
+  time_per_call(unsigned const n, F&& f)
+  {
+    return time_per_call(n, std::forward<F>(f), [] {});
+  }
+
+  inline void
+  report(std::string const& label, double const microseconds)
+  {
+    std::cout << std::left << std::setw(48) << label << std::right
+              << std::setw(14) << std::fixed << std::setprecision(3)
+              << microseconds << " us\n";
+  }
+
+  // Runs 'f' in a child process, waiting for it to finish.
+  template <typename F>
+  void
+  in_child_process(F const& f)
+  {
+    std::cout.flush();
+    if (auto const pid = fork(); pid == 0) {
+      f();
+      std::cout.flush();
+      _exit(0);
+    } else {
+      int status;
+      waitpid(pid, &status, 0);
+    }
+  }
+
+  // The private (unshared) memory of the calling process, in kB, as
+  // reported by the kernel.
+  inline long
+  private_memory()
+  {
+    std::ifstream in{"/proc/self/smaps_rollup"};
+    long result{};
+    for (std::string field; in >> field;) {
+      long kb;
+      if ((field == "Private_Clean:" || field == "Private_Dirty:") &&
+          in >> kb) {
+        result += kb;
+      }
+    }
+    return result;
+  }
+}
+
+#endif /* fhiclcpp_test_benchmarks_benchmark_helpers_h */
+
+// Local Variables:
+// mode: c++
+// End:
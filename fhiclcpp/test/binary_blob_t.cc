@@ -0,0 +1,76 @@
+#define BOOST_TEST_MODULE (binary blob test)
+#include "boost/test/unit_test.hpp"
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/detail/binary_blob.h"
+#include "fhiclcpp/exception.h"
+#include "fhiclcpp/test/boost_test_print_pset.h"
+
+#include <string>
+
+using namespace fhicl;
+using fhicl::detail::binary_blob;
+using namespace std::string_literals;
+
+namespace {
+  auto const config = "a: 7 "
+                      "b: @nil "
+                      "c: true "
+                      "d: -2.5e3 "
+                      "e: \"x\\\"y\" "
+                      "s: [1, 2, [3, 4], []] "
+                      "t: { u: hello v: [ {x: 1}, {x: 2} ] } "
+                      "empty: {} "
+                      "long_key_with_a_long_string_value: \"" +
+                      std::string(300, 'z') + "\""s;
+
+  bool
+  is_parse_error(fhicl::exception const& e)
+  {
+    return e.categoryCode() == error::parse_error;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+  auto const pset = ParameterSet::make(config);
+  auto const blob = binary_blob::encode(pset);
+  BOOST_TEST(static_cast<unsigned char>(blob.front()) == binary_blob::version);
+  auto const decoded = binary_blob::decode(blob);
+  BOOST_TEST(decoded == pset);
+  BOOST_TEST(decoded.id() == pset.id());
+  BOOST_TEST(decoded.to_compact_string() == pset.to_compact_string());
+  BOOST_TEST(decoded.get<std::string>("e") == "x\"y");
+  BOOST_TEST(decoded.get<int>("t.v[1].x") == 2);
+  BOOST_TEST(binary_blob::encode(decoded) == blob);
+
+  BOOST_TEST(binary_blob::decode(binary_blob::encode(ParameterSet{})) ==
+             ParameterSet{});
+}
+
+BOOST_AUTO_TEST_CASE(malformed)
+{
+  auto const blob = binary_blob::encode(ParameterSet::make(config));
+  BOOST_CHECK_EXCEPTION(
+    binary_blob::decode(""), fhicl::exception, is_parse_error);
+  BOOST_CHECK_EXCEPTION(binary_blob::decode(blob.substr(0, blob.size() - 1)),
+                        fhicl::exception,
+                        is_parse_error);
+  BOOST_CHECK_EXCEPTION(
+    binary_blob::decode(blob + '\0'), fhicl::exception, is_parse_error);
+  auto other_version = blob;
+  other_version[0] = binary_blob::version + 1;
+  BOOST_CHECK_EXCEPTION(
+    binary_blob::decode(other_version), fhicl::exception, is_parse_error);
+
+  // Counts larger than the bytes left are rejected before allocating.
+  std::string const huge_count{"\xff\xff\xff\xff\xff\xff\xff\x7f"};
+  std::string const version(1, static_cast<char>(binary_blob::version));
+  BOOST_CHECK_EXCEPTION(binary_blob::decode(version + huge_count),
+                        fhicl::exception,
+                        is_parse_error);
+  BOOST_CHECK_EXCEPTION(
+    binary_blob::decode(version + "\x01\x01s\x01" + huge_count),
+    fhicl::exception,
+    is_parse_error);
+}
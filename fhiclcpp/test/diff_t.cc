@@ -0,0 +1,107 @@
+#define BOOST_TEST_MODULE (diff test)
+#include "boost/test/unit_test.hpp"
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/diff.h"
+
+#include <string>
+#include <vector>
+
+using namespace fhicl;
+using namespace std::string_literals;
+
+namespace {
+  std::vector<std::string>
+  keys_of(std::vector<difference> const& diffs, difference_kind const kind)
+  {
+    std::vector<std::string> result;
+    for (auto const& d : diffs) {
+      if (d.kind == kind) {
+        result.push_back(d.key);
+      }
+    }
+    return result;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(diff_test)
+
+BOOST_AUTO_TEST_CASE(identical)
+{
+  auto const config = "a: 1 s: [1, {x: 2}] t: { u: { v: @nil } }"s;
+  BOOST_TEST(diff(ParameterSet::make(config), ParameterSet::make(config))
+               .empty());
+  BOOST_TEST(diff(ParameterSet{}, ParameterSet{}).empty());
+}
+
+BOOST_AUTO_TEST_CASE(differences)
+{
+  auto const from = ParameterSet::make("a: 1 "
+                                       "b: gone "
+                                       "s: [1, 2, 3] "
+                                       "k: { x: 1 } "
+                                       "t: { same: { p: 1 } "
+                                       "     u: { v: 1 w: [ {x: 1}, {x: 2} ] } "
+                                       "     n: @nil }");
+  auto const to = ParameterSet::make("a: \"1\" "
+                                     "c: new "
+                                     "s: [1, 5] "
+                                     "k: 3 "
+                                     "t: { same: { p: 1 } "
+                                     "     u: { v: 1 w: [ {x: 1}, {x: 3} ] } "
+                                     "     n: 0 }");
+  auto const diffs = diff(from, to);
+
+  BOOST_TEST(keys_of(diffs, difference_kind::added) ==
+             std::vector<std::string>{"c"});
+  BOOST_TEST(keys_of(diffs, difference_kind::removed) ==
+               (std::vector<std::string>{"b", "s[2]"}),
+             boost::test_tools::per_element());
+  std::vector<std::string> const changed{
+    "a", "k", "s[1]", "t.n", "t.u.w[1].x"};
+  BOOST_TEST(keys_of(diffs, difference_kind::changed) == changed,
+             boost::test_tools::per_element());
+
+  BOOST_TEST_REQUIRE(diffs.size() == 8ull);
+  auto const& a = diffs[0];
+  BOOST_TEST(a.key == "a");
+  BOOST_TEST(a.from_value == "1");
+  BOOST_TEST(a.to_value == "\"1\"");
+  auto const& c = diffs[2];
+  BOOST_TEST(c.key == "c");
+  BOOST_TEST(c.from_value.empty());
+  BOOST_TEST(c.to_value == "\"new\"");
+  auto const& k = diffs[3];
+  BOOST_TEST(k.from_value == "{x:1}");
+  BOOST_TEST(k.to_value == "3");
+  auto const& n = diffs[6];
+  BOOST_TEST(n.key == "t.n");
+  BOOST_TEST(n.from_value == "@nil");
+
+  // Reversing the arguments swaps additions and removals.
+  auto const reversed = diff(to, from);
+  BOOST_TEST(keys_of(reversed, difference_kind::added) ==
+               (std::vector<std::string>{"b", "s[2]"}),
+             boost::test_tools::per_element());
+  BOOST_TEST(keys_of(reversed, difference_kind::removed) ==
+             std::vector<std::string>{"c"});
+}
+
+BOOST_AUTO_TEST_CASE(source_information)
+{
+  auto const from = ParameterSet::make("a: 1\nt: { u: [1, 2] }");
+  auto const to = ParameterSet::make("a: 1\n\nt: { u: [1, 3] }\nb: 4");
+  auto const diffs = diff(from, to);
+  BOOST_TEST_REQUIRE(diffs.size() == 2ull);
+  BOOST_TEST(diffs[0].key == "b");
+  BOOST_TEST(diffs[0].from_src.empty());
+  BOOST_TEST(diffs[0].to_src == to.get_src_info("b"));
+  BOOST_TEST(diffs[1].key == "t.u[1]");
+  BOOST_TEST(diffs[1].from_src ==
+             from.get<ParameterSet>("t").get_src_info("u[1]"));
+  BOOST_TEST(diffs[1].to_src ==
+             to.get<ParameterSet>("t").get_src_info("u[1]"));
+  BOOST_TEST(diffs[1].from_src != diffs[1].to_src);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,8 @@
 #include "fhiclcpp/ParameterSet.h"
 #include "fhiclcpp/test/boost_test_print_pset.h"
 
+#include <vector>
+
 using namespace fhicl;
 
 BOOST_AUTO_TEST_SUITE(document_test)
@@ -16,4 +18,33 @@ BOOST_AUTO_TEST_CASE(leading_zeros)
   BOOST_TEST(pset1.get<int>("x") == pset2.get<int>("x"));
 }
 
+BOOST_AUTO_TEST_CASE(structural_equality_matches_id_equality)
+{
+  std::vector<ParameterSet> psets{
+    ParameterSet::make("a: 1 b: [1, 2, {c: 3}] d: { e: @nil f: \"x\" }"),
+    ParameterSet::make("a: 1 b: [1, 2, {c: 3}] d: { e: @nil f: \"y\" }"),
+    ParameterSet::make("a: 1 b: [1, 2, {c: 4}] d: { e: @nil f: \"x\" }"),
+    ParameterSet::make("a: 1 b: [1, 2] d: { e: @nil f: \"x\" }"),
+    ParameterSet::make("a: 1 b: [1, 2, {c: 3}] g: { e: @nil f: \"x\" }"),
+    ParameterSet::make("a: [1] b: [1, 2, {c: 3}] d: { e: @nil f: \"x\" }"),
+    ParameterSet::make("a: 1"),
+    ParameterSet{}};
+
+  // Modify the first ParameterSet so that its ID is invalidated,
+  // thus exercising the structural comparison.
+  auto modified = psets[0];
+  modified.put_or_replace("a", 2);
+  modified.put_or_replace("a", 1);
+  psets.push_back(modified);
+
+  for (auto const& lhs : psets) {
+    for (auto const& rhs : psets) {
+      auto const structurally_equal = (lhs == rhs);
+      BOOST_TEST(structurally_equal == (lhs.id() == rhs.id()));
+      // Both IDs are now cached.
+      BOOST_TEST((lhs == rhs) == structurally_equal);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
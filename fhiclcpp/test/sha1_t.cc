@@ -0,0 +1,89 @@
+#define BOOST_TEST_MODULE (sha1 test)
+#include "boost/test/unit_test.hpp"
+
+#include "cetlib/sha1.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/detail/sha1.h"
+
+#include <cstddef>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace fhicl;
+using namespace fhicl::detail;
+using namespace std::string_literals;
+
+namespace {
+  std::vector<sha1_backend> const all_backends{sha1_backend::portable,
+                                               sha1_backend::x86_sha_ni,
+                                               sha1_backend::armv8_sha};
+
+  std::string
+  hex(sha1_digest_t const& digest)
+  {
+    std::ostringstream os;
+    for (auto const byte : digest) {
+      os << std::hex << std::setfill('0') << std::setw(2) << unsigned{byte};
+    }
+    return os.str();
+  }
+
+  std::string
+  reference(std::string const& data)
+  {
+    cet::sha1 sha{data};
+    return hex(sha.digest());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(sha1_test)
+
+BOOST_AUTO_TEST_CASE(known_digests)
+{
+  for (auto const backend : all_backends) {
+    if (!sha1_backend_available(backend)) {
+      BOOST_CHECK_THROW(sha1("abc", backend), fhicl::exception);
+      continue;
+    }
+    BOOST_TEST_MESSAGE("Testing " << to_string(backend));
+    BOOST_TEST(hex(sha1("", backend)) ==
+               "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+    BOOST_TEST(hex(sha1("abc", backend)) ==
+               "a9993e364706816aba3e25717850c26c9cd0d89d");
+    BOOST_TEST(
+      hex(sha1("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+               backend)) == "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+    BOOST_TEST(hex(sha1(std::string(1000000, 'a'), backend)) ==
+               "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+  }
+  BOOST_TEST(sha1_backend_available(sha1_backend::portable));
+  BOOST_TEST(sha1_backend_available(sha1_default_backend()));
+}
+
+BOOST_AUTO_TEST_CASE(agrees_with_cetlib)
+{
+  // Every length up to three blocks exercises all of the padding
+  // cases.
+  std::string data;
+  for (std::size_t i = 0; i != 200; ++i) {
+    auto const expected = reference(data);
+    for (auto const backend : all_backends) {
+      if (sha1_backend_available(backend)) {
+        BOOST_TEST(hex(sha1(data, backend)) == expected,
+                   to_string(backend) << ", length " << i);
+      }
+    }
+    BOOST_TEST(hex(sha1(data)) == expected);
+    data += static_cast<char>('!' + (i * 7) % 90);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(parameter_set_id)
+{
+  auto const pset = ParameterSet::make("a: 1 b: [x, y] t: { u: \"z\" }");
+  BOOST_TEST(pset.id().to_string() == reference(pset.to_string()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,132 @@
+#define BOOST_TEST_MODULE (try_get test)
+#include "boost/test/unit_test.hpp"
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/test/boost_test_print_pset.h"
+
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace fhicl;
+using namespace std::string_literals;
+
+namespace {
+  auto const config = "i: -42 "
+                      "u: 42 "
+                      "big: 5000000000 "
+                      "x: 2.5 "
+                      "inf: -infinity "
+                      "b: true "
+                      "n: @nil "
+                      "s: hello "
+                      "q: \"17\" "
+                      "hex: 0x1F "
+                      "seq: [1, 2, 3] "
+                      "mixed: [1, {a: 1}] "
+                      "pair: [a, 2] "
+                      "t: { v: [ {x: 1}, {x: 2} ] }"s;
+
+  // 'try_get' must succeed exactly when 'get' does, with the same
+  // value.
+  template <typename T>
+  void
+  check_consistency(ParameterSet const& pset, std::string const& key)
+  {
+    auto const result = pset.try_get<T>(key);
+    try {
+      auto const expected = pset.get<T>(key);
+      BOOST_TEST_REQUIRE(result.has_value(), key);
+      BOOST_TEST((*result == expected), key);
+    }
+    catch (fhicl::exception const&) {
+      BOOST_TEST(!result.has_value(), key);
+    }
+  }
+
+  template <typename... T>
+  void
+  check_all_keys(ParameterSet const& pset)
+  {
+    for (auto const& [key, value] : pset) {
+      (check_consistency<T>(pset, std::string{key}), ...);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(try_get_test)
+
+BOOST_AUTO_TEST_CASE(values)
+{
+  auto const pset = ParameterSet::make(config);
+  BOOST_TEST(*pset.try_get<int>("i") == -42);
+  BOOST_TEST(*pset.try_get<unsigned>("u") == 42u);
+  BOOST_TEST(*pset.try_get<std::int64_t>("big") == 5000000000ll);
+  BOOST_TEST(*pset.try_get<double>("x") == 2.5);
+  BOOST_TEST(*pset.try_get<double>("inf") < 0.);
+  BOOST_TEST(*pset.try_get<bool>("b"));
+  BOOST_TEST(*pset.try_get<std::string>("s") == "hello");
+  BOOST_TEST(*pset.try_get<int>("q") == 17);
+  BOOST_TEST((*pset.try_get<std::vector<int>>("seq") == std::vector{1, 2, 3}));
+  BOOST_TEST((*pset.try_get<std::array<long, 3>>("seq") ==
+              std::array<long, 3>{1, 2, 3}));
+  BOOST_TEST((*pset.try_get<std::pair<std::string, int>>("pair") ==
+              std::pair{"a"s, 2}));
+  BOOST_TEST(pset.try_get<int>("t.v[1].x").value() == 2);
+  BOOST_TEST(pset.try_get<ParameterSet>("t.v[0]")->get<int>("x") == 1);
+  BOOST_TEST(pset.try_get<std::vector<ParameterSet>>("t.v")->size() == 2ull);
+  BOOST_TEST(pset.try_get<int>("z").value_or(3) == 3);
+}
+
+BOOST_AUTO_TEST_CASE(errors)
+{
+  auto const pset = ParameterSet::make(config);
+  BOOST_TEST((pset.try_get<int>("z").error() == get_error::missing));
+  BOOST_TEST((pset.try_get<int>("seq[3]").error() == get_error::missing));
+  BOOST_TEST((pset.try_get<int>("t.w.x").error() == get_error::missing));
+  BOOST_TEST((pset.try_get<int>("s").error() == get_error::type_mismatch));
+  BOOST_TEST((pset.try_get<int>("x").error() == get_error::type_mismatch));
+  BOOST_TEST((pset.try_get<int>("hex").error() == get_error::type_mismatch));
+  BOOST_TEST((pset.try_get<int>("seq").error() == get_error::type_mismatch));
+  BOOST_TEST(
+    (pset.try_get<std::string>("n").error() == get_error::type_mismatch));
+  BOOST_TEST(
+    (pset.try_get<std::string>("t").error() == get_error::type_mismatch));
+  BOOST_TEST(
+    (pset.try_get<ParameterSet>("seq").error() == get_error::type_mismatch));
+  BOOST_TEST((pset.try_get<std::vector<ParameterSet>>("mixed").error() ==
+              get_error::type_mismatch));
+  BOOST_TEST((pset.try_get<std::array<int, 2>>("seq").error() ==
+              get_error::type_mismatch));
+  BOOST_TEST((pset.try_get<unsigned>("i").error() == get_error::out_of_range));
+  BOOST_TEST((pset.try_get<int>("big").error() == get_error::out_of_range));
+  BOOST_TEST((pset.try_get<long>("inf").error() == get_error::out_of_range));
+}
+
+BOOST_AUTO_TEST_CASE(agrees_with_get)
+{
+  auto pset = ParameterSet::make(config);
+  pset.put("seq_string", "[4, 5]"s);
+  pset.put("escaped", "\"a\\\"b\""s);
+  check_all_keys<bool,
+                 int,
+                 unsigned,
+                 std::uint8_t,
+                 long long,
+                 float,
+                 double,
+                 std::string,
+                 std::vector<int>,
+                 std::vector<std::string>,
+                 std::vector<ParameterSet>,
+                 std::pair<std::string, int>,
+                 std::tuple<int, int, int>,
+                 std::complex<double>,
+                 ParameterSetID>(pset);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
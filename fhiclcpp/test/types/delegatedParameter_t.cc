@@ -3,9 +3,13 @@
 #include "boost/test/unit_test.hpp"
 
 #include "FixtureBase.h"
+#include "fhiclcpp/ParameterSetRegistry.h"
 #include "fhiclcpp/types/DelegatedParameter.h"
 #include "fhiclcpp/types/OptionalDelegatedParameter.h"
+#include "fhiclcpp/types/Sequence.h"
 
+#include <optional>
+#include <set>
 #include <string>
 
 using namespace fhicl;
@@ -23,6 +27,10 @@ namespace {
     Table<S> nested{Name("s")};
   };
 
+  struct Tables {
+    Sequence<Table<S>> seq{Name("seq")};
+  };
+
   struct Fixture : fhiclcpp_types::FixtureBase<Config> {
     Fixture() : FixtureBase("delegatedParameter_t.fcl") {}
   };
@@ -62,4 +70,56 @@ BOOST_AUTO_TEST_CASE(delegation_check)
   BOOST_TEST("Hello, Billy"s == maybe_string);
 }
 
+BOOST_AUTO_TEST_CASE(outlives_configuration)
+{
+  // The delegates do not refer to the validated ParameterSet.
+  std::optional<Table<Config>> table;
+  {
+    auto const copy = pset.get<ParameterSet>("pset");
+    table.emplace(copy, std::set<std::string>{});
+  }
+  receive_PSet((*table)().dt.get<ParameterSet>());
+  receive_int((*table)().nested().da.get<int>());
+  BOOST_TEST((*table)().nested().oda.hasValue());
+}
+
+BOOST_AUTO_TEST_CASE(sequence_of_tables)
+{
+  Table<Tables> const table{
+    ParameterSet::make("seq: [{ delegated_atom: 1 },"
+                       "      { delegated_atom: 2"
+                       "        optional_delegated_atom: x }]"),
+    {}};
+  BOOST_TEST(table().seq(0).da.get<int>() == 1);
+  BOOST_TEST(table().seq(1).da.get<int>() == 2);
+  BOOST_TEST(!table().seq(0).oda.hasValue());
+  BOOST_TEST(table().seq(1).oda.hasValue());
+}
+
+BOOST_AUTO_TEST_CASE(configuration_not_registered)
+{
+  // Only nested tables, which are already registered, are anchored.
+  auto const config =
+    ParameterSet::make("delegated_atom: 5 optional_delegated_atom: z");
+  Table<S> const table{config, {}};
+  BOOST_TEST(!ParameterSetRegistry::has(config.id()));
+  BOOST_TEST(table().da.get<int>() == 5);
+  BOOST_TEST(table().oda.hasValue());
+}
+
+BOOST_AUTO_TEST_CASE(survives_garbage_collection)
+{
+  // The enclosing tables need not be reachable from a root.
+  Table<S> const table{
+    ParameterSet::make("delegated_atom: 7 optional_delegated_atom: y"), {}};
+  auto const root = ParameterSet::make("unrelated_root: 1");
+  ParameterSetRegistry::put(root);
+  ParameterSetRegistry::add_root(root.id());
+  BOOST_TEST(ParameterSetRegistry::collect_garbage() > 0u);
+  BOOST_TEST(table().da.get<int>() == 7);
+  BOOST_TEST(table().oda.hasValue());
+  BOOST_TEST(config().nested().da.get<int>() == 3);
+  ParameterSetRegistry::remove_root(root.id());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -7,7 +7,6 @@
 #include "fhiclcpp/types/detail/DelegateBase.h"
 #include "fhiclcpp/types/detail/ParameterArgumentTypes.h"
 #include "fhiclcpp/types/detail/TableMemberRegistry.h"
-#include "fhiclcpp/types/detail/strip_containing_names.h"
 
 namespace fhicl {
 
@@ -27,18 +26,8 @@ namespace fhicl {
     auto
     get() const
     {
-      auto const trimmed_key = detail::strip_first_containing_name(key());
-      return pset_.get<T>(trimmed_key);
+      return enclosing_table().get<T>(name());
     }
-
-  private:
-    void
-    do_set_value(fhicl::ParameterSet const& pset) override
-    {
-      pset_ = pset;
-    };
-
-    fhicl::ParameterSet pset_{};
   };
 }
 
@@ -7,7 +7,6 @@
 #include "fhiclcpp/types/detail/DelegateBase.h"
 #include "fhiclcpp/types/detail/ParameterArgumentTypes.h"
 #include "fhiclcpp/types/detail/TableMemberRegistry.h"
-#include "fhiclcpp/types/detail/strip_containing_names.h"
 
 #include <functional>
 #include <optional>
@@ -27,20 +26,17 @@ namespace fhicl {
     bool
     hasValue() const
     {
-      return pset_ &&
-             pset_->has_key(detail::strip_first_containing_name(key()));
+      return has_enclosing_table() && enclosing_table().has_key(name());
     }
 
     template <typename T>
     std::optional<T>
     get_if_present() const
     {
-      if (not pset_) {
+      if (not has_enclosing_table()) {
         return std::nullopt;
       }
-
-      auto const trimmed_key = detail::strip_first_containing_name(key());
-      return pset_->get_if_present<T>(trimmed_key);
+      return enclosing_table().get_if_present<T>(name());
     }
 
     // Obsolete interface
@@ -54,15 +50,6 @@ namespace fhicl {
       }
       return false;
     }
-
-  private:
-    void
-    do_set_value(fhicl::ParameterSet const& pset) override
-    {
-      pset_ = std::make_optional(pset);
-    };
-
-    std::optional<ParameterSet> pset_{std::nullopt};
   };
 }
 
@@ -0,0 +1,58 @@
+#include "fhiclcpp/types/detail/DelegateBase.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/types/detail/strip_containing_names.h"
+
+namespace fhicl::detail {
+
+  ParameterSet const&
+  DelegateBase::enclosing_table() const
+  {
+    if (configuration_) {
+      return *configuration_;
+    }
+    if (!enclosing_table_) {
+      static ParameterSet const empty;
+      return empty;
+    }
+    return *enclosing_table_;
+  }
+
+  bool
+  DelegateBase::has_enclosing_table() const noexcept
+  {
+    return configuration_ || enclosing_table_;
+  }
+
+  void
+  DelegateBase::do_set_value(ParameterSet const& pset)
+  {
+    std::shared_ptr<ParameterSet const> configuration;
+    set_value(pset, configuration);
+  }
+
+  void
+  DelegateBase::set_value(ParameterSet const& pset,
+                          std::shared_ptr<ParameterSet const>& configuration)
+  {
+    // Nothing of a previously validated configuration is kept.
+    configuration_.reset();
+    enclosing_table_ = {};
+    // The key of the enclosing table, relative to 'pset'; it is empty
+    // if the delegate is a member of 'pset' itself.
+    auto const trimmed_key = strip_first_containing_name(key());
+    auto const pos = trimmed_key.find_last_of('.');
+    if (pos == std::string::npos) {
+      if (!configuration) {
+        configuration = std::make_shared<ParameterSet const>(pset);
+      }
+      configuration_ = configuration;
+      return;
+    }
+
+    // Nested tables are already registered.
+    auto const table = pset.lookup(trimmed_key.substr(0, pos));
+    if (table.is_table()) {
+      enclosing_table_ = ParameterSetRegistry::anchor{table.table().id()};
+    }
+  }
+}
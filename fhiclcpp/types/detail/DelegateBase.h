@@ -1,9 +1,12 @@
 #ifndef fhiclcpp_types_detail_DelegateBase_h
 #define fhiclcpp_types_detail_DelegateBase_h
 
+#include "fhiclcpp/ParameterSetRegistry.h"
 #include "fhiclcpp/types/ConfigPredicate.h"
 #include "fhiclcpp/types/detail/ParameterBase.h"
 
+#include <memory>
+
 namespace fhicl::detail {
   class DelegateBase : public ParameterBase {
   public:
@@ -13,6 +16,33 @@ namespace fhicl::detail {
                  std::function<bool()> maybeUse)
       : ParameterBase{name, comment, vt, par_type::DELEGATE, maybeUse}
     {}
+
+    using ParameterBase::set_value;
+    // Sets the value from 'pset', the validated configuration.  If the
+    // delegate is a member of 'pset' itself, it keeps 'configuration',
+    // a copy of 'pset' made by the first such delegate, so that the
+    // delegates of one validation share it.
+    void set_value(ParameterSet const& pset,
+                   std::shared_ptr<ParameterSet const>& configuration);
+
+  protected:
+    // The table that contains the delegated value, which is then
+    // retrieved via 'name()'.  A nested table is held by the
+    // ParameterSetRegistry and shared by all delegates within it; a
+    // delegate keeps only an anchor to it, so that it is neither
+    // evicted nor collected as garbage.  The enclosing table of a
+    // delegate that is a member of the validated configuration itself
+    // is the shared copy of that configuration, which is not
+    // registered.  If no value has been set, or the enclosing table is
+    // absent, an empty table is returned.
+    ParameterSet const& enclosing_table() const;
+    bool has_enclosing_table() const noexcept;
+
+  private:
+    void do_set_value(ParameterSet const& pset) final;
+
+    std::shared_ptr<ParameterSet const> configuration_{};
+    ParameterSetRegistry::anchor enclosing_table_{};
   };
 }
 
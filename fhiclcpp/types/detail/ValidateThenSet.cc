@@ -1,6 +1,7 @@
 #include "fhiclcpp/types/detail/ValidateThenSet.h"
 #include "cetlib/container_algorithms.h"
 #include "fhiclcpp/exception.h"
+#include "fhiclcpp/types/detail/DelegateBase.h"
 #include "fhiclcpp/types/detail/ParameterBase.h"
 #include "fhiclcpp/types/detail/PrintAllowedConfiguration.h"
 #include "fhiclcpp/types/detail/SequenceBase.h"
@@ -73,7 +74,10 @@ fhicl::detail::ValidateThenSet::before_action(ParameterBase& p)
 void
 fhicl::detail::ValidateThenSet::after_action(ParameterBase& p)
 {
-  p.set_value(pset_);
+  // Delegates are set by 'delegated_parameter'.
+  if (p.parameter_type() != par_type::DELEGATE) {
+    p.set_value(pset_);
+  }
 }
 
 //====================================================================
@@ -114,6 +118,7 @@ fhicl::detail::ValidateThenSet::delegated_parameter(DelegateBase& dp)
       return std::regex_search(k, r);
     });
   userKeys_.erase(erase_from, userKeys_.end());
+  dp.set_value(pset_, configuration_);
 }
 
 //====================================================================
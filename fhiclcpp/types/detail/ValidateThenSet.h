@@ -6,6 +6,7 @@
 #include "fhiclcpp/types/detail/ParameterBase.h"
 #include "fhiclcpp/types/detail/ParameterWalker.h"
 
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -31,6 +32,8 @@ namespace fhicl::detail {
     void atom(AtomBase&) override;
 
     ParameterSet const& pset_;
+    // Shared by the delegates that are members of 'pset_' itself.
+    std::shared_ptr<ParameterSet const> configuration_{};
     std::set<std::string> ignorableKeys_;
     std::vector<std::string> userKeys_;
     std::vector<cet::exempt_ptr<ParameterBase>> missingParameters_;
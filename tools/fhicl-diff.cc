@@ -0,0 +1,183 @@
+// ======================================================================
+//
+// Executable for listing the differences between two configurations
+//
+// The output has one line per difference:
+//
+//   - key: value          (only in the first configuration)
+//   + key: value          (only in the second configuration)
+//   ~ key: value -> value (changed)
+//
+// The exit status is 0 if the configurations are identical, and 1
+// otherwise.
+//
+// ======================================================================
+
+#include "cetlib/filepath_maker.h"
+#include "cetlib/ostream_handle.h"
+#include "cetlib/parsed_program_options.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/diff.h"
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+using namespace fhicl;
+
+using std::string;
+
+namespace {
+
+  string const fhicl_env_var{"FHICL_FILE_PATH"};
+
+  // Error categories
+  string const config{"Configuration"};
+
+  struct Help {
+    std::string msg;
+  };
+
+  struct Options {
+    bool annotate{false};
+    bool quiet{false};
+    string output_filename;
+    std::vector<string> input_filenames;
+    std::unique_ptr<cet::filepath_maker> policy;
+    string lookup_path;
+  };
+
+  std::variant<Options, Help> process_arguments(int argc, char** argv);
+
+  void print(std::ostream& os, difference const& d, bool annotate);
+}
+
+//======================================================================
+
+int
+main(int argc, char** argv)
+{
+  auto const opts_or_help = process_arguments(argc, argv);
+  if (std::holds_alternative<Help>(opts_or_help)) {
+    std::cout << std::get<Help>(opts_or_help).msg;
+    return 0;
+  }
+
+  auto const& opts = std::get<Options>(opts_or_help);
+  auto const from =
+    fhicl::ParameterSet::make(opts.input_filenames[0], *opts.policy);
+  auto const to =
+    fhicl::ParameterSet::make(opts.input_filenames[1], *opts.policy);
+
+  auto const differences = fhicl::diff(from, to);
+  if (!opts.quiet) {
+    auto os = cet::select_stream(opts.output_filename, std::cout);
+    for (auto const& d : differences) {
+      print(os, d, opts.annotate);
+    }
+  }
+  return differences.empty() ? 0 : 1;
+}
+
+//======================================================================
+
+namespace {
+
+  void
+  print(std::ostream& os, difference const& d, bool const annotate)
+  {
+    switch (d.kind) {
+    case difference_kind::added:
+      os << "+ " << d.key << ": " << d.to_value;
+      if (annotate && !d.to_src.empty()) {
+        os << "  # " << d.to_src;
+      }
+      break;
+    case difference_kind::removed:
+      os << "- " << d.key << ": " << d.from_value;
+      if (annotate && !d.from_src.empty()) {
+        os << "  # " << d.from_src;
+      }
+      break;
+    case difference_kind::changed:
+      os << "~ " << d.key << ": " << d.from_value << " -> " << d.to_value;
+      if (annotate && !(d.from_src.empty() && d.to_src.empty())) {
+        os << "  # " << (d.from_src.empty() ? "?" : d.from_src) << " -> "
+           << (d.to_src.empty() ? "?" : d.to_src);
+      }
+      break;
+    }
+    os << '\n';
+  }
+
+  std::variant<Options, Help>
+  process_arguments(int argc, char** argv)
+  {
+    namespace bpo = boost::program_options;
+
+    Options opts;
+
+    bpo::options_description desc(
+      "fhicl-diff <file1> <file2>\n\n"
+      "Lists the parameters that differ between two configurations.\n"
+      "Exits with status 0 if there are none, and 1 otherwise.\n\n"
+      "Options");
+    // clang-format off
+    desc.add_options()
+      ("help,h", "produce this help message")
+      ("inputs", bpo::value<std::vector<string>>(&opts.input_filenames),
+         "input files")
+      ("output,o", bpo::value<std::string>(&opts.output_filename),
+         "output file (default is STDOUT)")
+      ("annotate,a",
+         bpo::bool_switch(&opts.annotate),
+         "include source location annotations")
+      ("quiet,q",
+         bpo::bool_switch(&opts.quiet),
+         "suppress output; report differences via the exit status only")
+      ("lookup-policy,l",
+         bpo::value<string>()->default_value("permissive"), "see --supported-policies")
+      ("path,p",
+         bpo::value<std::string>(&opts.lookup_path)->default_value(fhicl_env_var),
+         "path or environment variable to be used by lookup-policy")
+      ("supported-policies", "list the supported file lookup policies");
+    // clang-format on
+
+    bpo::positional_options_description p;
+    p.add("inputs", 2);
+
+    auto const vm = cet::parsed_program_options(argc, argv, desc, p);
+
+    if (vm.count("help")) {
+      std::ostringstream os;
+      os << desc << '\n';
+      return Help{os.str()};
+    }
+
+    cet::lookup_policy_selector const supported_policies{};
+    if (vm.count("supported-policies")) {
+      return Help{supported_policies.help_message()};
+    }
+
+    if (opts.quiet && opts.annotate) {
+      throw cet::exception(config)
+        << "Cannot specify both '--quiet' and '--annotate' options.\n";
+    }
+
+    if (vm.count("lookup-policy") > 0) {
+      opts.policy = supported_policies.select(
+        vm["lookup-policy"].as<std::string>(), opts.lookup_path);
+    }
+
+    if (opts.input_filenames.size() != 2ull) {
+      std::ostringstream err_stream;
+      err_stream << "\nTwo input configuration files are required.\n\n"
+                 << desc << '\n';
+      throw cet::exception(config) << err_stream.str();
+    }
+    return opts;
+  }
+}
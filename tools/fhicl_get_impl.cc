@@ -192,8 +192,7 @@ interpreted according to the user-specified command-line.
   void
   print_names(fhicl::ParameterSet const& pset)
   {
-    auto const names = pset.get_names();
-    for (auto const& name : names) {
+    for (auto const& [name, value] : pset) {
       std::cout << name << '\n';
     }
   }
@@ -209,7 +208,13 @@ interpreted according to the user-specified command-line.
       return;
     }
 
-    if (not pset.has_key(key)) {
+    auto const table = pset.try_get<fhicl::ParameterSet>(key);
+    if (table) {
+      print_names(*table);
+      return;
+    }
+
+    if (table.error() == fhicl::get_error::missing) {
       if (allow_missing) {
         return;
       }
@@ -218,12 +223,8 @@ interpreted according to the user-specified command-line.
         << "' does not exist.";
     }
 
-    if (not pset.is_key_to_table(key)) {
-      throw cet::exception{config} << "The parameter named '" << key
-                                   << "' does not have a table value.";
-    }
-
-    print_names(pset.get<fhicl::ParameterSet>(key));
+    throw cet::exception{config} << "The parameter named '" << key
+                                 << "' does not have a table value.";
   }
 }
 